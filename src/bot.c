@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2024 Richard Braun.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS” AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE
+ * FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY
+ * DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *
+ * Forward-simulation autoplayer.
+ */
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bot.h"
+#include "eetg.h"
+#include "ei.h"
+#include "macros.h"
+
+/*
+ * Outcome penalties, in points.
+ */
+#define BOT_LIFE_PENALTY        1000
+#define BOT_GAME_OVER_PENALTY   10000
+
+static const int8_t bot_actions[BOT_NR_ACTIONS] = { -1, ' ', 's', 'f' };
+
+static void
+bot_discard(const void *buffer, size_t size, void *arg)
+{
+    (void)buffer;
+    (void)size;
+    (void)arg;
+}
+
+/*
+ * Xorshift generator, private to a worker, so that rollouts don't
+ * disturb the generators of the games.
+ */
+static uint32_t
+bot_worker_rand(struct bot_worker *worker)
+{
+    uint32_t x;
+
+    x = worker->rand_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    worker->rand_state = x;
+
+    return x;
+}
+
+/*
+ * Play a rollout, and return its outcome.
+ *
+ * The rollout ends early if the game leaves the playing state, e.g.
+ * when the player loses or wins a wave.
+ */
+static int64_t
+bot_worker_play(struct bot_worker *worker, int8_t action)
+{
+    struct ei_game *game = &worker->game;
+    int score, nr_lives;
+    int64_t value;
+
+    ei_game_restore(game, &worker->bot->snapshot);
+
+    score = game->score;
+    nr_lives = game->nr_lives;
+
+    ei_game_process(game, action);
+
+    for (unsigned int i = 1; i < worker->bot->depth; i++) {
+        if (game->state != EI_STATE_PLAYING) {
+            break;
+        }
+
+        action = bot_actions[bot_worker_rand(worker) % BOT_NR_ACTIONS];
+        ei_game_process(game, action);
+    }
+
+    value = game->score - score;
+    value -= (int64_t)(nr_lives - game->nr_lives) * BOT_LIFE_PENALTY;
+
+    if (game->state == EI_STATE_GAME_OVER) {
+        value -= BOT_GAME_OVER_PENALTY;
+    }
+
+    return value;
+}
+
+/*
+ * Play the share of rollouts of a worker.
+ *
+ * Rollouts are numbered, input-major, and dealt in turn to workers.
+ */
+static void
+bot_worker_run(struct bot_worker *worker)
+{
+    const struct bot *bot = worker->bot;
+    unsigned int nr_rollouts;
+
+    for (size_t i = 0; i < ARRAY_SIZE(worker->values); i++) {
+        worker->values[i] = 0;
+    }
+
+    nr_rollouts = bot->nr_rollouts * BOT_NR_ACTIONS;
+
+    for (unsigned int i = worker->index;
+         i < nr_rollouts;
+         i += bot->nr_workers) {
+        unsigned int action;
+
+        action = i / bot->nr_rollouts;
+        worker->values[action] += bot_worker_play(worker, bot_actions[action]);
+    }
+}
+
+static void *
+bot_worker_main(void *arg)
+{
+    struct bot_worker *worker = arg;
+    struct bot *bot = worker->bot;
+
+    for (;;) {
+        pthread_barrier_wait(&bot->start_barrier);
+
+        if (bot->stopping) {
+            break;
+        }
+
+        bot_worker_run(worker);
+        pthread_barrier_wait(&bot->end_barrier);
+    }
+
+    return NULL;
+}
+
+void
+bot_init(struct bot *bot, unsigned int nr_rollouts, unsigned int depth,
+         unsigned int nr_threads, unsigned int seed)
+{
+    int error;
+
+    assert(bot);
+    assert(nr_rollouts != 0);
+    assert(depth != 0);
+    assert(nr_threads != 0);
+    assert(nr_threads <= ARRAY_SIZE(bot->workers));
+
+    bot->nr_workers = nr_threads;
+    bot->nr_rollouts = nr_rollouts;
+    bot->depth = depth;
+    bot->stopping = false;
+
+    bot->stats.nr_rollouts = 0;
+    bot->stats.nr_ticks = 0;
+
+    error = pthread_barrier_init(&bot->start_barrier, NULL, nr_threads);
+    assert(!error);
+    error = pthread_barrier_init(&bot->end_barrier, NULL, nr_threads);
+    assert(!error);
+
+    for (unsigned int i = 0; i < nr_threads; i++) {
+        struct bot_worker *worker = &bot->workers[i];
+
+        worker->bot = bot;
+        worker->index = i;
+
+        /*
+         * The state of a xorshift generator must never be 0.
+         */
+        worker->rand_state = (seed + i) | 1;
+
+        ei_game_init(&worker->game, bot_discard, NULL);
+
+        if (i != 0) {
+            error = pthread_create(&worker->thread, NULL,
+                                   bot_worker_main, worker);
+            assert(!error);
+        }
+    }
+
+    (void)error;
+}
+
+void
+bot_destroy(struct bot *bot)
+{
+    assert(bot);
+
+    bot->stopping = true;
+    pthread_barrier_wait(&bot->start_barrier);
+
+    for (unsigned int i = 1; i < bot->nr_workers; i++) {
+        pthread_join(bot->workers[i].thread, NULL);
+    }
+
+    pthread_barrier_destroy(&bot->start_barrier);
+    pthread_barrier_destroy(&bot->end_barrier);
+}
+
+int8_t
+bot_select(struct bot *bot, const struct ei_game *game)
+{
+    int64_t values[BOT_NR_ACTIONS] = { 0 };
+    size_t best;
+
+    assert(bot);
+    assert(game);
+
+    /*
+     * Outside of waves, start a new game, or wait.
+     */
+    if (game->state != EI_STATE_PLAYING) {
+        return ' ';
+    }
+
+    ei_game_snapshot(game, &bot->snapshot);
+
+    pthread_barrier_wait(&bot->start_barrier);
+    bot_worker_run(&bot->workers[0]);
+    pthread_barrier_wait(&bot->end_barrier);
+
+    for (unsigned int i = 0; i < bot->nr_workers; i++) {
+        for (size_t j = 0; j < ARRAY_SIZE(values); j++) {
+            values[j] += bot->workers[i].values[j];
+        }
+    }
+
+    best = 0;
+
+    for (size_t i = 1; i < ARRAY_SIZE(values); i++) {
+        if (values[i] > values[best]) {
+            best = i;
+        }
+    }
+
+    bot->stats.nr_rollouts += bot->nr_rollouts * BOT_NR_ACTIONS;
+    bot->stats.nr_ticks++;
+
+    return bot_actions[best];
+}
+
+void
+bot_get_stats(const struct bot *bot, struct bot_stats *stats)
+{
+    assert(bot);
+    assert(stats);
+
+    *stats = bot->stats;
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2024 Richard Braun.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS” AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE
+ * FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY
+ * DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *
+ * Forward-simulation autoplayer.
+ *
+ * On each tick, the bot takes a snapshot of the game, and restores it
+ * into headless clones, from which it plays random rollouts, starting
+ * with each possible input, for a fixed number of ticks. The input with
+ * the best total outcome is selected. Rollouts may be spread over worker
+ * threads, each with its own clone.
+ */
+
+#ifndef BOT_H
+#define BOT_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ei.h"
+
+#define BOT_MAX_THREADS 32
+
+/*
+ * Default number of rollouts per input, and number of ticks per rollout.
+ */
+#define BOT_DEFAULT_NR_ROLLOUTS 8
+#define BOT_DEFAULT_DEPTH       (EI_TICK_RATE * 2)
+
+/*
+ * Inputs considered by the bot, including the absence of input.
+ */
+#define BOT_NR_ACTIONS 4
+
+struct bot_stats {
+    uint64_t nr_rollouts;
+    uint64_t nr_ticks;
+};
+
+struct bot;
+
+struct bot_worker {
+    struct bot *bot;
+    pthread_t thread;
+    struct ei_game game;
+    uint32_t rand_state;
+    int64_t values[BOT_NR_ACTIONS];
+    unsigned int index;
+};
+
+struct bot {
+    struct ei_snapshot snapshot;
+    struct bot_worker workers[BOT_MAX_THREADS];
+    pthread_barrier_t start_barrier;
+    pthread_barrier_t end_barrier;
+    unsigned int nr_workers;
+    unsigned int nr_rollouts;
+    unsigned int depth;
+    bool stopping;
+    struct bot_stats stats;
+};
+
+/*
+ * Initialize a bot.
+ *
+ * The bot plays the given number of rollouts per input, each lasting
+ * the given number of ticks, over the given number of threads, including
+ * the calling thread.
+ */
+void bot_init(struct bot *bot, unsigned int nr_rollouts, unsigned int depth,
+              unsigned int nr_threads, unsigned int seed);
+
+/*
+ * Stop the worker threads of a bot.
+ */
+void bot_destroy(struct bot *bot);
+
+/*
+ * Select the input for the next tick of a game, or -1 if none.
+ */
+int8_t bot_select(struct bot *bot, const struct ei_game *game);
+
+void bot_get_stats(const struct bot *bot, struct bot_stats *stats);
+
+#endif /* BOT_H */
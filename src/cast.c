@@ -0,0 +1,430 @@
+/*
+ * Copyright (c) 2024 Richard Braun.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS” AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE
+ * FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY
+ * DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *
+ * Spectator broadcast.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "cast.h"
+#include "eetg.h"
+#include "macros.h"
+
+static void
+cast_frame_append(struct cast_frame *frame, const void *buffer, size_t size)
+{
+    assert(frame);
+
+    if (frame->overflow || (size > (sizeof(frame->data) - frame->size))) {
+        frame->overflow = true;
+        return;
+    }
+
+    memcpy(&frame->data[frame->size], buffer, size);
+    frame->size += size;
+}
+
+static void
+cast_frame_ref(struct cast_frame *frame)
+{
+    assert(frame);
+
+    frame->nr_refs++;
+}
+
+static void
+cast_frame_unref(struct cast_frame *frame)
+{
+    assert(frame);
+    assert(frame->nr_refs != 0);
+
+    frame->nr_refs--;
+}
+
+static void
+cast_write_keyframe(const void *buffer, size_t size, void *arg)
+{
+    cast_frame_append(arg, buffer, size);
+}
+
+/*
+ * Drop the queued frames of a viewer, except the first nr_kept ones.
+ */
+static void
+cast_viewer_trim_queue(struct cast_viewer *viewer, unsigned int nr_kept)
+{
+    assert(viewer);
+    assert(nr_kept <= viewer->nr_frames);
+
+    for (unsigned int i = nr_kept; i < viewer->nr_frames; i++) {
+        cast_frame_unref(viewer->queue[(viewer->first + i)
+                                       % ARRAY_SIZE(viewer->queue)]);
+    }
+
+    viewer->nr_frames = nr_kept;
+
+    if (nr_kept == 0) {
+        viewer->first = 0;
+        viewer->offset = 0;
+    }
+}
+
+static void
+cast_viewer_drop_queue(struct cast_viewer *viewer)
+{
+    cast_viewer_trim_queue(viewer, 0);
+}
+
+/*
+ * Bring a viewer back with a keyframe.
+ *
+ * A frame partly sent is kept, so that the keyframe doesn't start in the
+ * middle of an escape sequence.
+ */
+static void
+cast_viewer_resync(struct cast *cast, struct cast_viewer *viewer)
+{
+    assert(cast);
+    assert(viewer);
+
+    cast_viewer_trim_queue(viewer, (viewer->offset == 0) ? 0 : 1);
+    viewer->synced = false;
+    cast->stats.nr_resyncs++;
+}
+
+static void
+cast_viewer_push(struct cast *cast, struct cast_viewer *viewer,
+                 struct cast_frame *frame)
+{
+    unsigned int index;
+
+    assert(viewer);
+
+    if (viewer->nr_frames == ARRAY_SIZE(viewer->queue)) {
+        cast_viewer_resync(cast, viewer);
+        return;
+    }
+
+    index = (viewer->first + viewer->nr_frames) % ARRAY_SIZE(viewer->queue);
+    viewer->queue[index] = frame;
+    viewer->nr_frames++;
+    cast_frame_ref(frame);
+}
+
+static void
+cast_remove_viewer(struct cast *cast, struct cast_viewer *viewer)
+{
+    assert(cast);
+    assert(viewer);
+    assert(viewer->fd != -1);
+
+    cast_viewer_drop_queue(viewer);
+    close(viewer->fd);
+    viewer->fd = -1;
+    cast->nr_viewers--;
+}
+
+/*
+ * Send the queued frames of a viewer, at once, from the frame buffers.
+ */
+static void
+cast_viewer_send(struct cast *cast, struct cast_viewer *viewer)
+{
+    struct iovec iov[CAST_QUEUE_SIZE];
+    struct msghdr msg;
+    ssize_t nr_bytes;
+    size_t size;
+
+    assert(cast);
+    assert(viewer);
+
+    if (viewer->nr_frames == 0) {
+        return;
+    }
+
+    for (unsigned int i = 0; i < viewer->nr_frames; i++) {
+        struct cast_frame *frame;
+
+        frame = viewer->queue[(viewer->first + i) % ARRAY_SIZE(viewer->queue)];
+        iov[i].iov_base = frame->data;
+        iov[i].iov_len = frame->size;
+    }
+
+    iov[0].iov_base = (char *)iov[0].iov_base + viewer->offset;
+    iov[0].iov_len -= viewer->offset;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = viewer->nr_frames;
+
+    nr_bytes = sendmsg(viewer->fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+
+    if (nr_bytes == -1) {
+        if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+            cast_remove_viewer(cast, viewer);
+        }
+
+        return;
+    }
+
+    cast->stats.nr_sent_bytes += nr_bytes;
+
+    size = nr_bytes;
+
+    while (size != 0) {
+        struct cast_frame *frame;
+        size_t remaining;
+
+        frame = viewer->queue[viewer->first];
+        remaining = frame->size - viewer->offset;
+
+        if (size < remaining) {
+            viewer->offset += size;
+            break;
+        }
+
+        size -= remaining;
+        cast_frame_unref(frame);
+        viewer->first = (viewer->first + 1) % ARRAY_SIZE(viewer->queue);
+        viewer->nr_frames--;
+        viewer->offset = 0;
+    }
+}
+
+static struct cast_frame *
+cast_find_free_frame(struct cast *cast)
+{
+    assert(cast);
+
+    for (size_t i = 0; i < ARRAY_SIZE(cast->frames); i++) {
+        if (cast->frames[i].nr_refs == 0) {
+            return &cast->frames[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Get a free frame buffer, owned by the caller.
+ */
+static struct cast_frame *
+cast_alloc_frame(struct cast *cast)
+{
+    struct cast_frame *frame;
+
+    assert(cast);
+
+    frame = cast_find_free_frame(cast);
+
+    if (!frame) {
+        for (size_t i = 0; i < ARRAY_SIZE(cast->viewers); i++) {
+            struct cast_viewer *viewer = &cast->viewers[i];
+
+            if (viewer->fd != -1) {
+                cast_viewer_resync(cast, viewer);
+            }
+        }
+
+        frame = cast_find_free_frame(cast);
+    }
+
+    /*
+     * Only frames partly sent to viewers too slow to finish them remain.
+     */
+    if (!frame) {
+        for (size_t i = 0; i < ARRAY_SIZE(cast->viewers); i++) {
+            struct cast_viewer *viewer = &cast->viewers[i];
+
+            if ((viewer->fd != -1) && (viewer->nr_frames != 0)) {
+                cast_remove_viewer(cast, viewer);
+            }
+        }
+
+        frame = cast_find_free_frame(cast);
+    }
+
+    assert(frame);
+
+    frame->size = 0;
+    frame->nr_refs = 1;
+    frame->overflow = false;
+
+    return frame;
+}
+
+void
+cast_init(struct cast *cast, eetg_write_fn write_fn, void *arg)
+{
+    assert(cast);
+
+    cast->write_fn = write_fn;
+    cast->write_fn_arg = arg;
+
+    for (size_t i = 0; i < ARRAY_SIZE(cast->frames); i++) {
+        cast->frames[i].nr_refs = 0;
+    }
+
+    cast->current = cast_alloc_frame(cast);
+
+    for (size_t i = 0; i < ARRAY_SIZE(cast->viewers); i++) {
+        cast->viewers[i].fd = -1;
+    }
+
+    cast->nr_viewers = 0;
+
+    memset(&cast->stats, 0, sizeof(cast->stats));
+}
+
+void
+cast_write(const void *buffer, size_t size, void *arg)
+{
+    struct cast *cast = arg;
+
+    assert(cast);
+
+    cast_frame_append(cast->current, buffer, size);
+
+    if (cast->write_fn) {
+        cast->write_fn(buffer, size, cast->write_fn_arg);
+    }
+}
+
+bool
+cast_add_viewer(struct cast *cast, int fd)
+{
+    assert(cast);
+    assert(fd != -1);
+
+    for (size_t i = 0; i < ARRAY_SIZE(cast->viewers); i++) {
+        struct cast_viewer *viewer = &cast->viewers[i];
+
+        if (viewer->fd == -1) {
+            viewer->first = 0;
+            viewer->nr_frames = 0;
+            viewer->offset = 0;
+            viewer->fd = fd;
+            viewer->synced = false;
+            cast->nr_viewers++;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void
+cast_end_frame(struct cast *cast, const struct eetg_world *world)
+{
+    struct cast_frame *frame;
+    bool keyframe_needed;
+
+    assert(cast);
+    assert(world);
+
+    frame = cast->current;
+    keyframe_needed = false;
+
+    for (size_t i = 0; i < ARRAY_SIZE(cast->viewers); i++) {
+        struct cast_viewer *viewer = &cast->viewers[i];
+
+        if (viewer->fd == -1) {
+            continue;
+        }
+
+        /*
+         * A viewer missing part of a frame must start over.
+         */
+        if (viewer->synced && frame->overflow) {
+            cast_viewer_resync(cast, viewer);
+        } else if (viewer->synced && (frame->size != 0)) {
+            cast_viewer_push(cast, viewer, frame);
+        }
+
+        if (!viewer->synced) {
+            keyframe_needed = true;
+        }
+    }
+
+    if (!frame->overflow && (frame->size != 0)) {
+        cast->stats.nr_frames++;
+        cast->stats.nr_encoded_bytes += frame->size;
+    }
+
+    cast_frame_unref(frame);
+
+    if (keyframe_needed) {
+        frame = cast_alloc_frame(cast);
+        eetg_world_write_keyframe(world, cast_write_keyframe, frame);
+
+        if (!frame->overflow) {
+            for (size_t i = 0; i < ARRAY_SIZE(cast->viewers); i++) {
+                struct cast_viewer *viewer = &cast->viewers[i];
+
+                if ((viewer->fd != -1) && !viewer->synced) {
+                    cast_viewer_push(cast, viewer, frame);
+                    viewer->synced = true;
+                }
+            }
+
+            cast->stats.nr_keyframes++;
+            cast->stats.nr_encoded_bytes += frame->size;
+        }
+
+        cast_frame_unref(frame);
+    }
+
+    cast->current = cast_alloc_frame(cast);
+
+    cast_flush(cast);
+}
+
+void
+cast_flush(struct cast *cast)
+{
+    assert(cast);
+
+    for (size_t i = 0; i < ARRAY_SIZE(cast->viewers); i++) {
+        struct cast_viewer *viewer = &cast->viewers[i];
+
+        if (viewer->fd != -1) {
+            cast_viewer_send(cast, viewer);
+        }
+    }
+}
+
+unsigned int
+cast_get_nr_viewers(const struct cast *cast)
+{
+    assert(cast);
+
+    return cast->nr_viewers;
+}
+
+void
+cast_get_stats(const struct cast *cast, struct cast_stats *stats)
+{
+    assert(cast);
+    assert(stats);
+
+    *stats = cast->stats;
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2024 Richard Braun.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS” AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE
+ * FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY
+ * DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *
+ * Spectator broadcast.
+ *
+ * A cast is a write backend recording the bytes of each frame of a world
+ * into a frame buffer, and forwarding them to another backend. At the end
+ * of a frame, the buffer is queued, by reference, to all viewers, which
+ * are non-blocking stream sockets. Frame buffers are reference counted,
+ * and released once sent to all viewers, so that the cost of encoding a
+ * frame doesn't depend on the number of viewers.
+ *
+ * Viewers start with a keyframe of the world, encoded once for all the
+ * viewers which need one at the end of a frame. Viewers which fall too
+ * far behind, or miss a frame for lack of buffer space, are brought back
+ * with a keyframe too, once done sending the frame they may have started.
+ */
+
+#ifndef CAST_H
+#define CAST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "eetg.h"
+
+#define CAST_MAX_VIEWERS    64
+
+/*
+ * Maximum number of frames queued to a viewer.
+ */
+#define CAST_QUEUE_SIZE     16
+
+/*
+ * Capacity of a frame buffer, in bytes.
+ */
+#define CAST_FRAME_SIZE     8192
+
+/*
+ * Number of frame buffers.
+ *
+ * Each frame adds at most one buffer to the queue of a viewer, which is
+ * either the frame itself, or a keyframe, so that the queued buffers
+ * normally come from the last CAST_QUEUE_SIZE frames. One more buffer
+ * records the current frame. If no buffer is free, all viewers are
+ * brought back with a keyframe.
+ */
+#define CAST_NR_FRAMES      ((CAST_QUEUE_SIZE * 2) + 1)
+
+struct cast_frame {
+    size_t size;
+    unsigned int nr_refs;
+    bool overflow;
+    char data[CAST_FRAME_SIZE];
+};
+
+struct cast_viewer {
+    struct cast_frame *queue[CAST_QUEUE_SIZE];
+    unsigned int first;
+    unsigned int nr_frames;
+    size_t offset;              /* bytes of the first frame already sent */
+    int fd;
+    bool synced;
+};
+
+struct cast_stats {
+    unsigned long nr_frames;
+    unsigned long nr_keyframes;
+    unsigned long nr_resyncs;
+    uint64_t nr_encoded_bytes;
+    uint64_t nr_sent_bytes;
+};
+
+struct cast {
+    eetg_write_fn write_fn;
+    void *write_fn_arg;
+    struct cast_frame frames[CAST_NR_FRAMES];
+    struct cast_frame *current;
+    struct cast_viewer viewers[CAST_MAX_VIEWERS];
+    unsigned int nr_viewers;
+    struct cast_stats stats;
+};
+
+/*
+ * Initialize a cast.
+ *
+ * If write_fn is NULL, bytes aren't forwarded.
+ */
+void cast_init(struct cast *cast, eetg_write_fn write_fn, void *arg);
+
+/*
+ * Write function, suitable for use as an engine write backend, with the
+ * cast as its argument.
+ */
+void cast_write(const void *buffer, size_t size, void *arg);
+
+/*
+ * Add a viewer.
+ *
+ * The cast takes ownership of the given socket, which it closes when the
+ * viewer disconnects. Return false if there are too many viewers.
+ */
+bool cast_add_viewer(struct cast *cast, int fd);
+
+/*
+ * End a frame of the given world, and queue it to viewers.
+ *
+ * The world must be the one writing to the cast.
+ */
+void cast_end_frame(struct cast *cast, const struct eetg_world *world);
+
+/*
+ * Send as many queued bytes as possible to viewers, without blocking.
+ */
+void cast_flush(struct cast *cast);
+
+unsigned int cast_get_nr_viewers(const struct cast *cast);
+
+void cast_get_stats(const struct cast *cast, struct cast_stats *stats);
+
+#endif /* CAST_H */
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2024 Richard Braun.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS” AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE
+ * FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY
+ * DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *
+ * Thin client.
+ *
+ * Decode the compact frame protocol from the standard input, and display
+ * it on the terminal, e.g. :
+ *
+ *   embedded_invaders -e | embedded_invaders_client
+ */
+
+#include <errno.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "wire.h"
+
+#define CLIENT_READ_SIZE 4096
+
+static struct wire_decoder decoder;
+
+static void
+write_terminal(const void *buffer, size_t size, void *arg)
+{
+    (void)arg;
+
+    write(STDOUT_FILENO, buffer, size);
+}
+
+int
+main(int argc, char *argv[])
+{
+    struct wire_stats stats;
+    char buffer[CLIENT_READ_SIZE];
+    uint64_t nr_received_bytes = 0;
+    bool valid = true;
+
+    if (argc != 1) {
+        fprintf(stderr, "usage: %s\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    /*
+     * An interrupt from the terminal also reaches the game, which closes
+     * the stream, so that the terminal is always restored.
+     */
+    signal(SIGINT, SIG_IGN);
+
+    wire_decoder_init(&decoder, write_terminal, NULL);
+
+    for (;;) {
+        ssize_t nr_bytes;
+
+        nr_bytes = read(STDIN_FILENO, buffer, sizeof(buffer));
+
+        if (nr_bytes == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            perror("read");
+            break;
+        } else if (nr_bytes == 0) {
+            break;
+        }
+
+        nr_received_bytes += nr_bytes;
+
+        if (!wire_decoder_write(&decoder, buffer, nr_bytes)) {
+            valid = false;
+            break;
+        }
+    }
+
+    write(STDOUT_FILENO, "\e[0m\e[?25h\n", 11);
+
+    if (!valid) {
+        fprintf(stderr, "invalid stream\n");
+        return EXIT_FAILURE;
+    }
+
+    wire_decoder_get_stats(&decoder, &stats);
+
+    fprintf(stderr, "frames: %lu, received bytes: %llu, "
+                    "terminal bytes: %llu\n",
+            stats.nr_frames, (unsigned long long)nr_received_bytes,
+            (unsigned long long)stats.nr_bytes);
+
+    return EXIT_SUCCESS;
+}
@@ -34,7 +34,199 @@
 
 #define EETG_CSI "\e["
 
-static unsigned int eetg_rand_next = 1;
+#define EETG_SYNC_UPDATE_START  EETG_CSI "?2026h"
+#define EETG_SYNC_UPDATE_END    EETG_CSI "?2026l"
+
+/*
+ * Maximum number of objects overlapping a moving compound object for
+ * which collisions are checked member per member. Beyond that, members
+ * are scanned against the whole world.
+ */
+#define EETG_MAX_CANDIDATES 16
+
+/*
+ * Maximum distance of the horizontal shifts detected between frames.
+ */
+#define EETG_MAX_SHIFT 2
+
+/*
+ * Estimated costs, in bytes, of a cursor move and a color change.
+ */
+#define EETG_CURSOR_COST    (sizeof(EETG_CSI "12;40H") - 1)
+#define EETG_COLOR_COST     (sizeof(EETG_CSI "30;40m") - 1)
+
+/*
+ * Cost of moving the cursor back to the top left corner, at the end of
+ * a frame.
+ */
+#define EETG_HOME_COST      (sizeof(EETG_CSI "1;1H") - 1)
+
+static unsigned int eetg_rand_seed = 1;
+
+static void
+eetg_object_table_init(struct eetg_object_table *table)
+{
+    assert(table);
+
+    table->nr_objects = 0;
+}
+
+static void
+eetg_object_table_store(struct eetg_object_table *table, int index,
+                        const struct eetg_object *object)
+{
+    assert(table);
+    assert(index >= 0);
+    assert(index < table->nr_objects);
+    assert(table->objects[index] == object);
+
+    table->x[index] = eetg_object_get_x(object);
+    table->y[index] = eetg_object_get_y(object);
+    table->width[index] = object->width;
+    table->height[index] = object->height;
+    table->type[index] = object->type;
+    table->color[index] = object->color;
+    table->is_static[index] = object->is_static;
+}
+
+static void
+eetg_object_table_add(struct eetg_object_table *table,
+                      struct eetg_object *object)
+{
+    assert(table);
+    assert(table->nr_objects < EETG_MAX_OBJECTS);
+
+    object->index = table->nr_objects;
+    table->objects[object->index] = object;
+    table->nr_objects++;
+}
+
+/*
+ * Remove an object from a table.
+ *
+ * The order of the remaining objects is preserved, since it's their
+ * stacking order.
+ */
+static void
+eetg_object_table_remove(struct eetg_object_table *table,
+                         struct eetg_object *object)
+{
+    int index;
+    size_t nr_moved;
+
+    assert(table);
+
+    index = object->index;
+    assert(table->objects[index] == object);
+
+    table->nr_objects--;
+    nr_moved = table->nr_objects - index;
+
+    memmove(&table->objects[index], &table->objects[index + 1],
+            nr_moved * sizeof(table->objects[0]));
+    memmove(&table->x[index], &table->x[index + 1],
+            nr_moved * sizeof(table->x[0]));
+    memmove(&table->y[index], &table->y[index + 1],
+            nr_moved * sizeof(table->y[0]));
+    memmove(&table->width[index], &table->width[index + 1],
+            nr_moved * sizeof(table->width[0]));
+    memmove(&table->height[index], &table->height[index + 1],
+            nr_moved * sizeof(table->height[0]));
+    memmove(&table->type[index], &table->type[index + 1],
+            nr_moved * sizeof(table->type[0]));
+    memmove(&table->color[index], &table->color[index + 1],
+            nr_moved * sizeof(table->color[0]));
+    memmove(&table->is_static[index], &table->is_static[index + 1],
+            nr_moved * sizeof(table->is_static[0]));
+
+    for (int i = index; i < table->nr_objects; i++) {
+        table->objects[i]->index = i;
+    }
+}
+
+static bool
+eetg_object_table_overlaps(const struct eetg_object_table *table, int index,
+                           int x, int y, int width, int height)
+{
+    assert(table);
+
+    return (table->x[index] < (x + width))
+           && (x < (table->x[index] + table->width[index]))
+           && (table->y[index] < (y + height))
+           && (y < (table->y[index] + table->height[index]));
+}
+
+/*
+ * Return true if the given area, in world coordinates, is entirely
+ * outside a viewport.
+ */
+static bool
+eetg_viewport_excludes(const struct eetg_viewport *viewport,
+                       int x, int y, int width, int height)
+{
+    assert(viewport);
+
+    x -= viewport->x;
+    y -= viewport->y;
+
+    return (x >= viewport->nr_columns) || ((x + width) <= 0)
+           || (y >= viewport->nr_rows) || ((y + height) <= 0);
+}
+
+/*
+ * Return true if an object of a table is visible in the given spans,
+ * one per view row, through the given viewport.
+ *
+ * Objects outside the viewport are rejected by their bounding box.
+ */
+static bool
+eetg_object_table_is_visible(const struct eetg_object_table *table, int index,
+                             const struct eetg_viewport *viewport,
+                             const struct eetg_span *spans)
+{
+    int x, y, start, end;
+
+    assert(table);
+
+    if (eetg_viewport_excludes(viewport, table->x[index], table->y[index],
+                               table->width[index], table->height[index])) {
+        return false;
+    }
+
+    x = table->x[index] - viewport->x;
+    y = table->y[index] - viewport->y;
+    start = (y < 0) ? 0 : y;
+    end = y + table->height[index];
+
+    if (end > EETG_MAX_ROWS) {
+        end = EETG_MAX_ROWS;
+    }
+
+    for (int row = start; row < end; row++) {
+        const struct eetg_span *span = &spans[row];
+
+        if ((span->start < (x + table->width[index])) && (x < span->end)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Update the entry of an object in the table of its world, if it's part
+ * of a world on its own.
+ */
+static void
+eetg_object_sync(struct eetg_object *object)
+{
+    assert(object);
+
+    if (object->world) {
+        eetg_object_table_store(&object->world->objects, object->index,
+                                object);
+    }
+}
 
 static void
 eetg_object_set(struct eetg_object *object, struct eetg_world *world,
@@ -42,11 +234,12 @@ eetg_object_set(struct eetg_object *object, struct eetg_world *world,
 {
     assert(object);
     assert(!object->world);
+    assert(!object->parent);
     assert(world);
 
     object->world = world;
-    object->x = x;
-    object->y = y;
+    object->x = x - object->extent_x;
+    object->y = y - object->extent_y;
 }
 
 static void
@@ -56,7 +249,34 @@ eetg_object_unset(struct eetg_object *object)
     assert(object->world);
 
     object->world = NULL;
-    object->next = NULL;
+    object->index = -1;
+}
+
+/*
+ * Return the absolute position of the origin of an object.
+ */
+static int
+eetg_object_get_origin_x(const struct eetg_object *object)
+{
+    assert(object);
+
+    return (object->parent ? object->parent->x : 0) + object->x;
+}
+
+static int
+eetg_object_get_origin_y(const struct eetg_object *object)
+{
+    assert(object);
+
+    return (object->parent ? object->parent->y : 0) + object->y;
+}
+
+static bool
+eetg_mask_is_live(const struct eetg_mask *mask, int x, int y)
+{
+    assert(mask);
+
+    return (mask->rows[y] & (UINT64_C(1) << x)) != 0;
 }
 
 static char
@@ -71,7 +291,14 @@ eetg_object_get_char(const struct eetg_object *object, int x, int y)
         return index;
     }
 
-    return object->sprite[index];
+    if (object->mask
+        && !eetg_mask_is_live(object->mask,
+                              x - eetg_object_get_origin_x(object),
+                              y - eetg_object_get_origin_y(object))) {
+        return ' ';
+    }
+
+    return object->sprite->text[index];
 }
 
 static void
@@ -80,26 +307,61 @@ eetg_object_check_collision(struct eetg_object *object1,
                             eetg_handle_collision_fn handle_collision_fn,
                             void *handle_collision_fn_arg)
 {
-    int o1xbr, o1ybr, o2xbr, o2ybr;
+    int o1xtl, o1ytl, o1xbr, o1ybr, o2xtl, o2ytl, o2xbr, o2ybr;
     int xtl, ytl, xbr, ybr;
 
     assert(object1);
     assert(object2);
     assert(handle_collision_fn);
 
-    o1xbr = object1->x + object1->width - 1;
-    o1ybr = object1->y + object1->height - 1;
+    o1xtl = eetg_object_get_x(object1);
+    o1ytl = eetg_object_get_y(object1);
+    o1xbr = o1xtl + object1->width - 1;
+    o1ybr = o1ytl + object1->height - 1;
 
-    o2xbr = object2->x + object2->width - 1;
-    o2ybr = object2->y + object2->height - 1;
+    o2xtl = eetg_object_get_x(object2);
+    o2ytl = eetg_object_get_y(object2);
+    o2xbr = o2xtl + object2->width - 1;
+    o2ybr = o2ytl + object2->height - 1;
 
-    if ((object2->x > o1xbr) || (object1->x > o2xbr) ||
-        (object2->y > o1ybr) || (object1->y > o2ybr)) {
+    if ((o2xtl > o1xbr) || (o1xtl > o2xbr) ||
+        (o2ytl > o1ybr) || (o1ytl > o2ybr)) {
         return;
     }
 
-    xtl = (object1->x > object2->x) ? object1->x : object2->x;
-    ytl = (object1->y > object2->y) ? object1->y : object2->y;
+    /*
+     * The bounding boxes overlap, narrow down to the members of compounds.
+     * Members may be removed by the collision function, and a compound
+     * may be removed from its world altogether.
+     */
+    if (object1->is_compound || object2->is_compound) {
+        struct eetg_object *compound, *member, *next;
+
+        compound = object1->is_compound ? object1 : object2;
+
+        for (member = compound->members; member; member = next) {
+            next = member->next;
+
+            if (compound == object1) {
+                eetg_object_check_collision(member, object2,
+                                            handle_collision_fn,
+                                            handle_collision_fn_arg);
+            } else {
+                eetg_object_check_collision(object1, member,
+                                            handle_collision_fn,
+                                            handle_collision_fn_arg);
+            }
+
+            if (!compound->world) {
+                break;
+            }
+        }
+
+        return;
+    }
+
+    xtl = (o1xtl > o2xtl) ? o1xtl : o2xtl;
+    ytl = (o1ytl > o2ytl) ? o1ytl : o2ytl;
     xbr = (o1xbr < o2xbr) ? o1xbr : o2xbr;
     ybr = (o1ybr < o2ybr) ? o1ybr : o2ybr;
 
@@ -128,12 +390,19 @@ eetg_object_check_collision(struct eetg_object *object1,
 
 static void
 eetg_view_cell_set(struct eetg_view_cell *view_cell,
-                   char c, int color)
+                   char c, int color, int priority)
 {
     assert(view_cell);
 
     view_cell->c = c;
     view_cell->color = color;
+    view_cell->priority = priority;
+}
+
+static void
+eetg_view_cell_clear(struct eetg_view_cell *view_cell)
+{
+    eetg_view_cell_set(view_cell, ' ', EETG_FG_COLOR, EETG_PRIORITY_DEFAULT);
 }
 
 static char
@@ -152,6 +421,26 @@ eetg_view_cell_get_color(const struct eetg_view_cell *view_cell)
     return view_cell->color;
 }
 
+static int
+eetg_view_cell_get_priority(const struct eetg_view_cell *view_cell)
+{
+    assert(view_cell);
+
+    return view_cell->priority;
+}
+
+static int
+eetg_view_cell_get_update_priority(const struct eetg_view_cell *view_cell,
+                                   const struct eetg_view_cell *prev_view_cell)
+{
+    int priority, prev_priority;
+
+    priority = eetg_view_cell_get_priority(view_cell);
+    prev_priority = eetg_view_cell_get_priority(prev_view_cell);
+
+    return (priority > prev_priority) ? priority : prev_priority;
+}
+
 static struct eetg_view_cell *
 eetg_view_row_get_cell(struct eetg_view_row *view_row, int index)
 {
@@ -171,7 +460,18 @@ eetg_view_row_init(struct eetg_view_row *view_row)
         struct eetg_view_cell *view_cell;
 
         view_cell = eetg_view_row_get_cell(view_row, (int)i);
-        eetg_view_cell_set(view_cell, ' ', EETG_BG_COLOR);
+        eetg_view_cell_set(view_cell, ' ', EETG_BG_COLOR,
+                           EETG_PRIORITY_DEFAULT);
+    }
+}
+
+static void
+eetg_view_row_clear(struct eetg_view_row *view_row)
+{
+    assert(view_row);
+
+    for (size_t i = 0; i < ARRAY_SIZE(view_row->columns); i++) {
+        eetg_view_cell_clear(eetg_view_row_get_cell(view_row, (int)i));
     }
 }
 
@@ -195,525 +495,3678 @@ eetg_view_init(struct eetg_view *view)
     }
 }
 
-void
-eetg_world_init(struct eetg_world *world, eetg_write_fn write_fn, void *arg)
+static void
+eetg_view_clear(struct eetg_view *view, int nr_rows)
 {
-    assert(world);
-    assert(write_fn);
-
-    world->write_fn = write_fn;
-    world->write_fn_arg = arg;
-
-    world->handle_collision_fn = NULL;
-    world->objects = NULL;
+    assert(view);
+    assert(nr_rows <= (int)ARRAY_SIZE(view->rows));
 
-    eetg_view_init(&world->views[0]);
-    eetg_view_init(&world->views[1]);
+    for (int row = 0; row < nr_rows; row++) {
+        eetg_view_row_clear(eetg_view_get_row(view, row));
+    }
+}
 
-    world->view = &world->views[0];
-    world->prev_view = &world->views[1];
+static void
+eetg_span_init(struct eetg_span *span)
+{
+    assert(span);
 
-    world->cursor_row = -1;
-    world->cursor_column = -1;
-    world->current_color = EETG_FG_COLOR;
+    span->start = EETG_MAX_COLUMNS;
+    span->end = 0;
 }
 
-void
-eetg_world_clear(struct eetg_world *world)
+static bool
+eetg_span_empty(const struct eetg_span *span)
 {
-    struct eetg_object *object;
-
-    assert(world);
+    assert(span);
 
-    object = world->objects;
+    return (span->start >= span->end);
+}
 
-    while (object) {
-        struct eetg_object *next = object->next;
+static void
+eetg_span_extend(struct eetg_span *span, int start, int end)
+{
+    assert(span);
+    assert(start < end);
 
-        eetg_object_unset(object);
-        object = next;
+    if (start < span->start) {
+        span->start = start;
     }
 
-    world->objects = NULL;
+    if (end > span->end) {
+        span->end = end;
+    }
 }
 
-void
-eetg_world_register_collision_fn(struct eetg_world *world,
-                                 eetg_handle_collision_fn handle_collision_fn,
-                                 void *arg)
+int
+eetg_world_get_nr_columns(const struct eetg_world *world)
 {
     assert(world);
-    assert(handle_collision_fn);
 
-    world->handle_collision_fn = handle_collision_fn;
-    world->handle_collision_fn_arg = arg;
+#if EETG_FIXED_SIZE
+    (void)world;
+    return EETG_COLUMNS;
+#else /* EETG_FIXED_SIZE */
+    return world->nr_columns;
+#endif /* EETG_FIXED_SIZE */
 }
 
-static void
-eetg_world_scan_collisions(struct eetg_world *world, struct eetg_object *object)
+int
+eetg_world_get_nr_rows(const struct eetg_world *world)
 {
     assert(world);
 
-    if (!world->handle_collision_fn) {
-        return;
-    }
+#if EETG_FIXED_SIZE
+    (void)world;
+    return EETG_ROWS;
+#else /* EETG_FIXED_SIZE */
+    return world->nr_rows;
+#endif /* EETG_FIXED_SIZE */
+}
 
-    for (struct eetg_object *tmp = world->objects; tmp; tmp = tmp->next) {
-        if (tmp == object) {
-            continue;
-        }
+int
+eetg_world_get_viewport_x(const struct eetg_world *world)
+{
+    assert(world);
 
-        eetg_object_check_collision(object, tmp,
-                                    world->handle_collision_fn,
-                                    world->handle_collision_fn_arg);
-    }
+    return world->viewport.x;
 }
 
-void
-eetg_world_add(struct eetg_world *world, struct eetg_object *object,
-               int x, int y)
+int
+eetg_world_get_viewport_y(const struct eetg_world *world)
 {
     assert(world);
-    assert(eetg_object_get_world(object) == NULL);
 
-    object->next = world->objects;
-    world->objects = object;
+    return world->viewport.y;
+}
 
-    eetg_object_set(object, world, x, y);
-    eetg_world_scan_collisions(world, object);
+int
+eetg_world_get_viewport_nr_columns(const struct eetg_world *world)
+{
+    assert(world);
+
+#if EETG_FIXED_SIZE
+    (void)world;
+    return EETG_COLUMNS;
+#else /* EETG_FIXED_SIZE */
+    return world->viewport.nr_columns;
+#endif /* EETG_FIXED_SIZE */
 }
 
-void
-eetg_world_remove(struct eetg_world *world, struct eetg_object *object)
+int
+eetg_world_get_viewport_nr_rows(const struct eetg_world *world)
 {
     assert(world);
-    assert(eetg_object_get_world(object) == world);
 
-    if (world->objects == object) {
-        world->objects = object->next;
-        goto out;
-    }
+#if EETG_FIXED_SIZE
+    (void)world;
+    return EETG_ROWS;
+#else /* EETG_FIXED_SIZE */
+    return world->viewport.nr_rows;
+#endif /* EETG_FIXED_SIZE */
+}
 
-    for (struct eetg_object *tmp = world->objects; tmp->next; tmp = tmp->next) {
-        if (tmp->next == object) {
-            tmp->next = tmp->next->next;
-            break;
-        }
-    }
+static int
+eetg_output_get_nr_columns(const struct eetg_output *output)
+{
+    assert(output);
 
-out:
-    eetg_object_unset(object);
+    return eetg_world_get_viewport_nr_columns(output->world);
 }
 
-static void
-eetg_object_render_row(struct eetg_object *object, int row,
-                       struct eetg_view_row *view_row)
+static int
+eetg_output_get_nr_rows(const struct eetg_output *output)
 {
-    const char *line;
+    assert(output);
 
-    assert(object);
-    assert(row < object->height);
+    return eetg_world_get_viewport_nr_rows(output->world);
+}
 
-    line = &object->sprite[(object->width + 1) * row];
+/*
+ * Damage an area, in world coordinates.
+ */
+static void
+eetg_world_damage(struct eetg_world *world, int x, int y,
+                  int width, int height)
+{
+    int start, end, nr_columns, nr_rows;
 
-    for (int obj_column = 0; obj_column < object->width; obj_column++) {
-        int column = object->x + obj_column;
-        char c;
+    assert(world);
 
-        if ((column < 0) || (column >= EETG_COLUMNS)) {
-            continue;
-        }
+    nr_columns = eetg_world_get_viewport_nr_columns(world);
+    nr_rows = eetg_world_get_viewport_nr_rows(world);
+    x -= world->viewport.x;
+    y -= world->viewport.y;
 
-        c = line[obj_column];
+    start = (x < 0) ? 0 : x;
+    end = ((x + width) > nr_columns) ? nr_columns : (x + width);
 
-        if (c != ' ') {
-            struct eetg_view_cell *view_cell;
+    if (start >= end) {
+        return;
+    }
 
-            view_cell = eetg_view_row_get_cell(view_row, column);
-            eetg_view_cell_set(view_cell, c, object->color);
+    for (int row = y; row < (y + height); row++) {
+        if ((row < 0) || (row >= nr_rows)) {
+            continue;
         }
+
+        eetg_span_extend(&world->damage[row], start, end);
     }
 }
 
 static void
-eetg_object_render(struct eetg_object *object, struct eetg_view *view)
+eetg_world_damage_all(struct eetg_world *world)
 {
-    assert(object);
+    eetg_world_damage(world, world->viewport.x, world->viewport.y,
+                      eetg_world_get_viewport_nr_columns(world),
+                      eetg_world_get_viewport_nr_rows(world));
+}
 
-    for (int obj_row = 0; obj_row < object->height; obj_row++) {
-        int row = object->y + obj_row;
+/*
+ * Initialize spans covering the whole viewport of a world, one per view
+ * row.
+ */
+static void
+eetg_world_init_spans(const struct eetg_world *world,
+                      struct eetg_span spans[EETG_MAX_ROWS])
+{
+    int nr_columns, nr_rows;
 
-        if ((row < 0) || (row >= EETG_ROWS)) {
-            continue;
-        }
+    nr_columns = eetg_world_get_viewport_nr_columns(world);
+    nr_rows = eetg_world_get_viewport_nr_rows(world);
 
-        eetg_object_render_row(object, obj_row, eetg_view_get_row(view, row));
+    for (int i = 0; i < EETG_MAX_ROWS; i++) {
+        eetg_span_init(&spans[i]);
+
+        if (i < nr_rows) {
+            eetg_span_extend(&spans[i], 0, nr_columns);
+        }
     }
 }
 
+/*
+ * Drop the cached encoding of an object, if any.
+ */
 static void
-eetg_world_write(struct eetg_world *world, const void *buffer, size_t size)
+eetg_object_invalidate_encoding(struct eetg_object *object)
 {
-    assert(world);
-    assert(world->write_fn);
-    assert(buffer);
+    assert(object);
 
-#if EETG_RENDERING_DISABLED
-    (void)buffer;
-    (void)size;
-#else
-    world->write_fn(buffer, size, world->write_fn_arg);
-#endif
+    if (object->encoding) {
+        object->encoding->valid = false;
+    }
 }
 
+/*
+ * Record the area covered by an object as damaged, so that it gets
+ * composited again on the next frame.
+ */
 static void
-eetg_world_write_str(struct eetg_world *world, const char *str)
+eetg_object_damage(struct eetg_object *object)
 {
-    eetg_world_write(world, str, strlen(str));
-}
+    struct eetg_world *world;
 
-static void
-eetg_world_set_cursor(struct eetg_world *world, int row, int column)
-{
-    char str[32];
+    assert(object);
 
-    assert(world);
-    assert(row >= 0);
-    assert(row < EETG_ROWS);
-    assert(column >= 0);
-    assert(column < EETG_COLUMNS);
+    world = eetg_object_get_world(object);
 
-    if ((world->cursor_row == row) && (world->cursor_column == column)) {
+    if (!world) {
         return;
     }
 
-    snprintf(str, sizeof(str), EETG_CSI "%d;%dH", row + 1, column + 1);
-    eetg_world_write_str(world, str);
+    if (object->is_static || (object->parent && object->parent->is_static)) {
+        world->base_view_valid = false;
+    }
 
-    world->cursor_row = row;
-    world->cursor_column = column;
+    eetg_world_damage(world, eetg_object_get_x(object),
+                      eetg_object_get_y(object),
+                      object->width, object->height);
 }
 
-static int
-eetg_convert_fg_color(int color)
+/*
+ * Update the bounding box of a compound object from its members.
+ */
+static void
+eetg_object_update_extents(struct eetg_object *object)
 {
-    return color + 30;
-}
+    int xtl, ytl, xbr, ybr;
+
+    assert(object);
+    assert(object->is_compound);
+
+    if (!object->members) {
+        object->extent_x = 0;
+        object->extent_y = 0;
+        object->width = 0;
+        object->height = 0;
+        eetg_object_sync(object);
+        return;
+    }
+
+    xtl = INT_MAX;
+    ytl = INT_MAX;
+    xbr = INT_MIN;
+    ybr = INT_MIN;
+
+    for (struct eetg_object *member = object->members;
+         member;
+         member = member->next) {
+        if (member->x < xtl) {
+            xtl = member->x;
+        }
+
+        if (member->y < ytl) {
+            ytl = member->y;
+        }
+
+        if ((member->x + member->width) > xbr) {
+            xbr = member->x + member->width;
+        }
+
+        if ((member->y + member->height) > ybr) {
+            ybr = member->y + member->height;
+        }
+    }
+
+    object->extent_x = xtl;
+    object->extent_y = ytl;
+    object->width = xbr - xtl;
+    object->height = ybr - ytl;
+
+    eetg_object_sync(object);
+}
+
+void
+eetg_output_init(struct eetg_output *output, eetg_write_fn write_fn, void *arg)
+{
+    assert(output);
+    assert(write_fn);
+
+    output->world = NULL;
+    output->next = NULL;
+    output->write_fn = write_fn;
+    output->writev_fn = NULL;
+    output->write_fn_arg = arg;
+    output->span_fn = NULL;
+    output->span_fn_arg = NULL;
+
+    eetg_view_init(&output->prev_view);
+
+    for (size_t i = 0; i < ARRAY_SIZE(output->pending); i++) {
+        eetg_span_init(&output->pending[i]);
+    }
+
+    output->byte_budget = 0;
+    output->nr_written = 0;
+    output->progressed = false;
+
+    output->output_flags = 0;
+    output->in_session = false;
+    output->frame_pending = false;
+    output->in_frame = false;
+    output->sync_pending = false;
+    output->synced = false;
+
+    output->cursor_row = -1;
+    output->cursor_column = -1;
+    output->pan_x = 0;
+    output->pan_y = 0;
+    output->current_color = EETG_FG_COLOR;
+}
+
+void
+eetg_world_init(struct eetg_world *world, eetg_write_fn write_fn, void *arg)
+{
+    assert(world);
+
+    eetg_output_init(&world->output, write_fn, arg);
+    world->output.world = world;
+
+    world->handle_collision_fn = NULL;
+    eetg_object_table_init(&world->objects);
+
+    eetg_view_init(&world->view);
+    eetg_view_init(&world->base_view);
+    world->base_view_valid = false;
+
+    for (size_t i = 0; i < ARRAY_SIZE(world->damage); i++) {
+        eetg_span_init(&world->damage[i]);
+    }
+
+    world->viewport.x = 0;
+    world->viewport.y = 0;
+    world->viewport.nr_columns = EETG_COLUMNS;
+    world->viewport.nr_rows = EETG_ROWS;
+    world->nr_columns = EETG_COLUMNS;
+    world->nr_rows = EETG_ROWS;
+    eetg_world_damage_all(world);
+
+    world->rand_next = eetg_rand_seed;
+}
+
+/*
+ * Clear the views of a world and its outputs, after the viewport is
+ * resized, and have it fully repainted on the next frame.
+ */
+static void
+eetg_world_reset_views(struct eetg_world *world)
+{
+    /*
+     * Cells beyond the viewport must remain blank, and outputs may not
+     * show its content at the new size, so clear everything and repaint.
+     */
+    eetg_view_init(&world->view);
+    eetg_view_init(&world->base_view);
+    world->base_view_valid = false;
+
+    for (size_t i = 0; i < ARRAY_SIZE(world->damage); i++) {
+        eetg_span_init(&world->damage[i]);
+    }
+
+    eetg_world_damage_all(world);
+
+    /*
+     * Encodings are clipped to the viewport.
+     */
+    for (int i = 0; i < world->objects.nr_objects; i++) {
+        struct eetg_object *object = world->objects.objects[i];
+
+        eetg_object_invalidate_encoding(object);
+
+        for (struct eetg_object *member = object->members;
+             member;
+             member = member->next) {
+            eetg_object_invalidate_encoding(member);
+        }
+    }
+
+    for (struct eetg_output *output = &world->output;
+         output;
+         output = output->next) {
+        eetg_view_init(&output->prev_view);
+
+        for (size_t i = 0; i < ARRAY_SIZE(output->pending); i++) {
+            eetg_span_init(&output->pending[i]);
+        }
+
+        output->sync_pending = true;
+    }
+}
+
+void
+eetg_world_set_size(struct eetg_world *world, int nr_columns, int nr_rows)
+{
+    assert(world);
+    assert(nr_columns > 0);
+    assert(nr_columns <= EETG_MAX_WORLD_SIZE);
+    assert(nr_rows > 0);
+    assert(nr_rows <= EETG_MAX_WORLD_SIZE);
+    assert(!EETG_FIXED_SIZE
+           || ((nr_columns == EETG_COLUMNS) && (nr_rows == EETG_ROWS)));
+
+    world->nr_columns = nr_columns;
+    world->nr_rows = nr_rows;
+
+    world->viewport.x = 0;
+    world->viewport.y = 0;
+    world->viewport.nr_columns = (nr_columns > EETG_MAX_COLUMNS)
+                                 ? EETG_MAX_COLUMNS
+                                 : nr_columns;
+    world->viewport.nr_rows = (nr_rows > EETG_MAX_ROWS)
+                              ? EETG_MAX_ROWS
+                              : nr_rows;
+
+    eetg_world_reset_views(world);
+}
+
+void
+eetg_world_resize_viewport(struct eetg_world *world,
+                           int nr_columns, int nr_rows)
+{
+    assert(world);
+    assert(nr_columns > 0);
+    assert(nr_columns <= EETG_MAX_COLUMNS);
+    assert(nr_rows > 0);
+    assert(nr_rows <= EETG_MAX_ROWS);
+    assert(!EETG_FIXED_SIZE
+           || ((nr_columns == EETG_COLUMNS) && (nr_rows == EETG_ROWS)));
+
+    world->viewport.nr_columns = nr_columns;
+    world->viewport.nr_rows = nr_rows;
+
+    eetg_world_reset_views(world);
+}
+
+static int
+eetg_clamp_pan(int pan)
+{
+    if (pan < -EETG_MAX_WORLD_SIZE) {
+        return -EETG_MAX_WORLD_SIZE;
+    } else if (pan > EETG_MAX_WORLD_SIZE) {
+        return EETG_MAX_WORLD_SIZE;
+    }
+
+    return pan;
+}
+
+void
+eetg_world_move_viewport(struct eetg_world *world, int x, int y)
+{
+    int dx, dy;
+
+    assert(world);
+    assert(x >= -EETG_MAX_WORLD_SIZE);
+    assert(x <= EETG_MAX_WORLD_SIZE);
+    assert(y >= -EETG_MAX_WORLD_SIZE);
+    assert(y <= EETG_MAX_WORLD_SIZE);
+
+    dx = x - world->viewport.x;
+    dy = y - world->viewport.y;
+
+    if ((dx == 0) && (dy == 0)) {
+        return;
+    }
+
+    world->viewport.x = x;
+    world->viewport.y = y;
+
+    /*
+     * Outputs record the moves since they last rendered, so that they
+     * can scroll what they display accordingly.
+     */
+    for (struct eetg_output *output = &world->output;
+         output;
+         output = output->next) {
+        output->pan_x = eetg_clamp_pan(output->pan_x + dx);
+        output->pan_y = eetg_clamp_pan(output->pan_y + dy);
+    }
+
+    world->base_view_valid = false;
+    eetg_world_damage_all(world);
+}
+
+void
+eetg_world_add_output(struct eetg_world *world, struct eetg_output *output)
+{
+    assert(world);
+    assert(output);
+    assert(!output->world);
+
+    output->world = world;
+    output->next = world->output.next;
+    world->output.next = output;
+
+    output->sync_pending = true;
+}
+
+void
+eetg_world_remove_output(struct eetg_world *world, struct eetg_output *output)
+{
+    assert(world);
+    assert(output);
+    assert(output->world == world);
+    assert(output != &world->output);
+
+    for (struct eetg_output *tmp = &world->output; tmp; tmp = tmp->next) {
+        if (tmp->next == output) {
+            tmp->next = output->next;
+            break;
+        }
+    }
+
+    output->world = NULL;
+    output->next = NULL;
+}
+
+struct eetg_output *
+eetg_world_get_output(struct eetg_world *world)
+{
+    assert(world);
+
+    return &world->output;
+}
+
+void
+eetg_world_clear(struct eetg_world *world)
+{
+    struct eetg_object_table *table;
+
+    assert(world);
+
+    table = &world->objects;
+
+    for (int i = table->nr_objects - 1; i >= 0; i--) {
+        struct eetg_object *object = table->objects[i];
+
+        eetg_object_damage(object);
+        eetg_object_unset(object);
+    }
+
+    eetg_object_table_init(table);
+    world->base_view_valid = false;
+}
+
+void
+eetg_world_register_collision_fn(struct eetg_world *world,
+                                 eetg_handle_collision_fn handle_collision_fn,
+                                 void *arg)
+{
+    assert(world);
+    assert(handle_collision_fn);
+
+    world->handle_collision_fn = handle_collision_fn;
+    world->handle_collision_fn_arg = arg;
+}
+
+/*
+ * Scan collisions for an object.
+ *
+ * The collision function may remove objects, including the one being
+ * scanned, or the one it collides with, in which case the scan ends.
+ * Since removals move objects in the table, the objects overlapping the
+ * scanned object are collected first. After each call, the position of
+ * the scanned object is fetched again, and the remaining candidates are
+ * skipped if they were removed, or don't overlap it any more.
+ */
+static void
+eetg_world_scan_collisions(struct eetg_world *world, struct eetg_object *object)
+{
+    struct eetg_object *candidates[EETG_MAX_OBJECTS];
+    const struct eetg_object_table *table;
+    size_t nr_candidates = 0;
+    int x, y;
+
+    assert(world);
+
+    if (!world->handle_collision_fn) {
+        return;
+    }
+
+    table = &world->objects;
+    x = eetg_object_get_x(object);
+    y = eetg_object_get_y(object);
+
+    for (int i = table->nr_objects - 1; i >= 0; i--) {
+        struct eetg_object *tmp = table->objects[i];
+
+        if ((tmp == object) || (tmp == object->parent)
+            || !eetg_object_table_overlaps(table, i, x, y,
+                                           object->width, object->height)) {
+            continue;
+        }
+
+        candidates[nr_candidates] = tmp;
+        nr_candidates++;
+    }
+
+    for (size_t i = 0; i < nr_candidates; i++) {
+        struct eetg_object *tmp = candidates[i];
+
+        if ((tmp->world != world)
+            || !eetg_object_table_overlaps(table, tmp->index, x, y,
+                                           object->width, object->height)) {
+            continue;
+        }
+
+        eetg_object_check_collision(object, tmp,
+                                    world->handle_collision_fn,
+                                    world->handle_collision_fn_arg);
+
+        if (tmp->world != world) {
+            break;
+        }
+
+        x = eetg_object_get_x(object);
+        y = eetg_object_get_y(object);
+    }
+}
+
+/*
+ * Scan collisions for a compound object.
+ *
+ * The objects overlapping the compound are collected first, after which
+ * each member is checked against them, as if it had been moved on its
+ * own. As with a plain scan, the scan of a member ends if the object it
+ * collides with is removed.
+ */
+static void
+eetg_world_scan_compound_collisions(struct eetg_world *world,
+                                    struct eetg_object *object)
+{
+    struct eetg_object *candidates[EETG_MAX_CANDIDATES];
+    const struct eetg_object_table *table;
+    struct eetg_object *member, *next;
+    size_t nr_candidates = 0;
+    int x, y;
+
+    assert(world);
+    assert(object->is_compound);
+
+    if (!world->handle_collision_fn) {
+        return;
+    }
+
+    table = &world->objects;
+    x = eetg_object_get_x(object);
+    y = eetg_object_get_y(object);
+
+    for (int i = table->nr_objects - 1; i >= 0; i--) {
+        struct eetg_object *tmp = table->objects[i];
+
+        if ((tmp == object)
+            || !eetg_object_table_overlaps(table, i, x, y,
+                                           object->width, object->height)) {
+            continue;
+        }
+
+        if (nr_candidates == ARRAY_SIZE(candidates)) {
+            nr_candidates = SIZE_MAX;
+            break;
+        }
+
+        candidates[nr_candidates] = tmp;
+        nr_candidates++;
+    }
+
+    for (member = object->members; member; member = next) {
+        next = member->next;
+
+        if (nr_candidates == SIZE_MAX) {
+            eetg_world_scan_collisions(world, member);
+        } else {
+            for (size_t i = 0; i < nr_candidates; i++) {
+                struct eetg_object *tmp = candidates[i];
+
+                if (tmp->world != world) {
+                    continue;
+                }
+
+                eetg_object_check_collision(member, tmp,
+                                            world->handle_collision_fn,
+                                            world->handle_collision_fn_arg);
+
+                if (tmp->world != world) {
+                    break;
+                }
+            }
+        }
+
+        if (object->world != world) {
+            break;
+        }
+    }
+}
+
+void
+eetg_world_add(struct eetg_world *world, struct eetg_object *object,
+               int x, int y)
+{
+    assert(world);
+    assert(eetg_object_get_world(object) == NULL);
+    assert(!object->parent);
+
+    eetg_object_table_add(&world->objects, object);
+    eetg_object_set(object, world, x, y);
+    eetg_object_sync(object);
+    eetg_object_damage(object);
+
+    if (object->is_compound) {
+        eetg_world_scan_compound_collisions(world, object);
+    } else {
+        eetg_world_scan_collisions(world, object);
+    }
+}
+
+void
+eetg_world_remove(struct eetg_world *world, struct eetg_object *object)
+{
+    assert(world);
+    assert(eetg_object_get_world(object) == world);
+    assert(!object->parent);
+
+    eetg_object_table_remove(&world->objects, object);
+    eetg_object_damage(object);
+    eetg_object_unset(object);
+}
+
+static void
+eetg_object_render_row(struct eetg_object *object, int row, int x,
+                       struct eetg_view_row *view_row,
+                       const struct eetg_span *span)
+{
+    const struct eetg_sprite *sprite;
+    const struct eetg_sprite_run *run, *end;
+    struct eetg_view_cell *view_cell;
+    int start_column, end_column;
+    const char *line;
+
+    assert(object);
+    assert(row < object->height);
+    assert(span);
+    assert(span->start >= 0);
+    assert(span->end <= EETG_MAX_COLUMNS);
+
+    sprite = object->sprite;
+    line = &sprite->text[sprite->row_offsets[row]];
+    run = &sprite->runs[sprite->row_runs[row]];
+    end = &sprite->runs[sprite->row_runs[row + 1]];
+
+    /*
+     * Clip once, in sprite coordinates.
+     */
+    start_column = span->start - x;
+    end_column = span->end - x;
+
+    for (; run < end; run++) {
+        int run_start, run_end;
+
+        run_start = run->column;
+        run_end = run_start + run->length;
+
+        if (run_start >= end_column) {
+            break;
+        } else if (run_end <= start_column) {
+            continue;
+        }
+
+        if (run_start < start_column) {
+            run_start = start_column;
+        }
+
+        if (run_end > end_column) {
+            run_end = end_column;
+        }
+
+        view_cell = eetg_view_row_get_cell(view_row, x + run_start);
+
+        if (object->mask) {
+            uint64_t live = object->mask->rows[row];
+
+            for (int i = run_start; i < run_end; i++) {
+                if (live & (UINT64_C(1) << i)) {
+                    eetg_view_cell_set(view_cell, line[i],
+                                       object->color, object->priority);
+                }
+
+                view_cell++;
+            }
+
+            continue;
+        }
+
+        for (int i = run_start; i < run_end; i++) {
+            eetg_view_cell_set(view_cell, line[i],
+                               object->color, object->priority);
+            view_cell++;
+        }
+    }
+}
+
+/*
+ * Render an object through the given viewport, limited to the given
+ * spans, one per view row.
+ *
+ * Objects, and members of compounds, outside the viewport are rejected
+ * by their bounding box.
+ */
+static void
+eetg_object_render(struct eetg_object *object,
+                   const struct eetg_viewport *viewport,
+                   struct eetg_view *view, const struct eetg_span *spans)
+{
+    int x, y;
+
+    assert(object);
+
+    if (eetg_viewport_excludes(viewport, eetg_object_get_x(object),
+                               eetg_object_get_y(object),
+                               object->width, object->height)) {
+        return;
+    }
+
+    if (object->is_compound) {
+        for (struct eetg_object *member = object->members;
+             member;
+             member = member->next) {
+            eetg_object_render(member, viewport, view, spans);
+        }
+
+        return;
+    }
+
+    x = eetg_object_get_origin_x(object) - viewport->x;
+    y = eetg_object_get_origin_y(object) - viewport->y;
+
+    for (int obj_row = 0; obj_row < object->height; obj_row++) {
+        int row = y + obj_row;
+
+        if ((row < 0) || (row >= EETG_MAX_ROWS)
+            || eetg_span_empty(&spans[row])) {
+            continue;
+        }
+
+        eetg_object_render_row(object, obj_row, x,
+                               eetg_view_get_row(view, row), &spans[row]);
+    }
+}
+
+static void
+eetg_output_emit(struct eetg_output *output, const void *buffer, size_t size)
+{
+    assert(output);
+    assert(output->write_fn);
+    assert(buffer);
+
+#if EETG_RENDERING_DISABLED
+    (void)output;
+    (void)buffer;
+    (void)size;
+#else
+    output->write_fn(buffer, size, output->write_fn_arg);
+#endif
+}
+
+/*
+ * Prepare for writing bytes, opening the synchronized update of the
+ * current frame first, if pending, so that frames without changes write
+ * nothing, and account for them.
+ */
+static void
+eetg_output_begin_write(struct eetg_output *output, size_t size)
+{
+    assert(output);
+
+    if (output->frame_pending) {
+        output->frame_pending = false;
+        output->in_frame = true;
+        eetg_output_emit(output, EETG_SYNC_UPDATE_START,
+                         sizeof(EETG_SYNC_UPDATE_START) - 1);
+    }
+
+    output->nr_written += size;
+    output->progressed = true;
+}
+
+static void
+eetg_output_write(struct eetg_output *output, const void *buffer, size_t size)
+{
+    eetg_output_begin_write(output, size);
+    eetg_output_emit(output, buffer, size);
+}
+
+static void
+eetg_output_write_str(struct eetg_output *output, const char *str)
+{
+    eetg_output_write(output, str, strlen(str));
+}
+
+static void
+eetg_output_writev(struct eetg_output *output,
+                   const struct eetg_buffer *buffers, size_t nr_buffers)
+{
+    size_t size;
+
+    assert(output);
+    assert(nr_buffers <= EETG_MAX_BUFFERS);
+
+    if (nr_buffers == 0) {
+        return;
+    }
+
+    if (!output->writev_fn) {
+        for (size_t i = 0; i < nr_buffers; i++) {
+            eetg_output_write(output, buffers[i].data, buffers[i].size);
+        }
+
+        return;
+    }
+
+    size = 0;
+
+    for (size_t i = 0; i < nr_buffers; i++) {
+        size += buffers[i].size;
+    }
+
+    eetg_output_begin_write(output, size);
+
+#if EETG_RENDERING_DISABLED
+    (void)buffers;
+#else
+    output->writev_fn(buffers, nr_buffers, output->write_fn_arg);
+#endif
+}
+
+static void
+eetg_output_set_cursor(struct eetg_output *output, int row, int column)
+{
+    char str[32];
+
+    assert(output);
+    assert(row >= 0);
+    assert(row < eetg_output_get_nr_rows(output));
+    assert(column >= 0);
+    assert(column < eetg_output_get_nr_columns(output));
+
+    if ((output->cursor_row == row) && (output->cursor_column == column)) {
+        return;
+    }
+
+    snprintf(str, sizeof(str), EETG_CSI "%d;%dH", row + 1, column + 1);
+    eetg_output_write_str(output, str);
+
+    output->cursor_row = row;
+    output->cursor_column = column;
+}
+
+static int
+eetg_convert_fg_color(int color)
+{
+    return color + 30;
+}
+
+static int
+eetg_convert_bg_color(int color)
+{
+    return eetg_convert_fg_color(color) + 10;
+}
+
+static void
+eetg_output_set_color(struct eetg_output *output, int color, bool force)
+{
+    char str[16];
+
+    if ((color == output->current_color) && !force) {
+        return;
+    }
+
+    snprintf(str, sizeof(str), EETG_CSI "%d;%dm",
+             eetg_convert_fg_color(color),
+             eetg_convert_bg_color(EETG_BG_COLOR));
+
+    eetg_output_write_str(output, str);
+
+    output->current_color = color;
+}
+
+static void
+eetg_output_write_char(struct eetg_output *output, char c)
+{
+    eetg_output_write(output, &c, sizeof(c));
+
+    output->cursor_column++;
+
+    /*
+     * Terminals defer wrapping until the next character is written, and
+     * sequences such as insert/delete characters apply to the last
+     * column in the meantime. Force the cursor to be set again instead.
+     */
+    if (output->cursor_column == eetg_output_get_nr_columns(output)) {
+        output->cursor_row = -1;
+        output->cursor_column = -1;
+    }
+}
+
+static int
+eetg_count_digits(int value)
+{
+    int nr_digits = 1;
+
+    assert(value >= 0);
+
+    while (value >= 10) {
+        value /= 10;
+        nr_digits++;
+    }
+
+    return nr_digits;
+}
+
+static size_t
+eetg_output_get_update_cost(const struct eetg_output *output,
+                            int row, int column, int color)
+{
+    size_t cost = 1;
+
+    assert(output);
+
+    if ((output->cursor_row != row) || (output->cursor_column != column)) {
+        cost += sizeof(EETG_CSI ";H") - 1
+                + eetg_count_digits(row + 1)
+                + eetg_count_digits(column + 1);
+    }
+
+    if (color != output->current_color) {
+        cost += sizeof(EETG_CSI "30;40m") - 1;
+    }
+
+    return cost;
+}
+
+/*
+ * Emit a single cell and record it as displayed.
+ *
+ * Return false if the update doesn't fit in the byte budget, in which
+ * case the previous view is left untouched so that the cell is compared
+ * again, and emitted, on the next frame. If nothing was written yet in
+ * the frame, e.g. a block of moved cells, the update is emitted whatever
+ * the budget.
+ */
+static bool
+eetg_output_update_cell(struct eetg_output *output, int row, int column,
+                        const struct eetg_view_cell *view_cell,
+                        struct eetg_view_cell *prev_view_cell)
+{
+    int color;
+
+    assert(output);
+
+    color = eetg_view_cell_get_color(view_cell);
+
+    if ((output->byte_budget != 0) && output->progressed) {
+        size_t cost;
+
+        cost = eetg_output_get_update_cost(output, row, column, color);
+
+        if ((output->nr_written + cost) > output->byte_budget) {
+            return false;
+        }
+    }
+
+    eetg_output_set_cursor(output, row, column);
+    eetg_output_set_color(output, color, false);
+    eetg_output_write_char(output, eetg_view_cell_get_c(view_cell));
+
+    *prev_view_cell = *view_cell;
+
+    return true;
+}
+
+static bool
+eetg_view_cell_equals(const struct eetg_view_cell *view_cell1,
+                      const struct eetg_view_cell *view_cell2)
+{
+    return (eetg_view_cell_get_c(view_cell1)
+            == eetg_view_cell_get_c(view_cell2))
+           && (eetg_view_cell_get_color(view_cell1)
+               == eetg_view_cell_get_color(view_cell2));
+}
+
+/*
+ * Estimate the number of bytes needed to turn a displayed row into
+ * another. A NULL displayed row stands for a blank row.
+ *
+ * Only the columns from start to end are compared, which gives the same
+ * estimate as the whole row if the others are equal.
+ */
+static size_t
+eetg_view_row_get_update_cost(const struct eetg_view_row *view_row,
+                              const struct eetg_view_row *prev_view_row,
+                              int start, int end)
+{
+    struct eetg_view_cell blank;
+    int next_column, color;
+    size_t cost;
+
+    eetg_view_cell_clear(&blank);
+
+    cost = 0;
+    next_column = -1;
+    color = -1;
+
+    assert(start >= 0);
+    assert(end <= (int)ARRAY_SIZE(view_row->columns));
+
+    for (int column = start; column < end; column++) {
+        const struct eetg_view_cell *view_cell, *prev_view_cell;
+
+        view_cell = &view_row->columns[column];
+        prev_view_cell = prev_view_row
+                         ? &prev_view_row->columns[column]
+                         : &blank;
+
+        if (eetg_view_cell_equals(view_cell, prev_view_cell)) {
+            continue;
+        }
+
+        if (column != next_column) {
+            cost += EETG_CURSOR_COST;
+        }
+
+        if (eetg_view_cell_get_color(view_cell) != color) {
+            color = eetg_view_cell_get_color(view_cell);
+            cost += EETG_COLOR_COST;
+        }
+
+        cost++;
+        next_column = column + 1;
+    }
+
+    return cost;
+}
+
+/*
+ * Shift the cells of a row of the given number of columns, starting at
+ * the given column, as done by a terminal when inserting (positive
+ * distance) or deleting (negative distance) characters. Cells shifted
+ * past the end of the row are lost, and blank cells fill the gap.
+ */
+static void
+eetg_view_row_shift(struct eetg_view_row *view_row, int nr_columns,
+                    int column, int distance)
+{
+    struct eetg_view_cell *cells;
+
+    assert(view_row);
+    assert(nr_columns <= (int)ARRAY_SIZE(view_row->columns));
+    assert(column >= 0);
+    assert(column < nr_columns);
+    assert(distance != 0);
+
+    cells = view_row->columns;
+
+    if (distance > 0) {
+        if (distance > (nr_columns - column)) {
+            distance = nr_columns - column;
+        }
+
+        memmove(&cells[column + distance], &cells[column],
+                (nr_columns - column - distance) * sizeof(cells[0]));
+
+        for (int i = column; i < (column + distance); i++) {
+            eetg_view_cell_clear(&cells[i]);
+        }
+    } else {
+        distance = -distance;
+
+        if (distance > (nr_columns - column)) {
+            distance = nr_columns - column;
+        }
+
+        memmove(&cells[column], &cells[column + distance],
+                (nr_columns - column - distance) * sizeof(cells[0]));
+
+        for (int i = nr_columns - distance; i < nr_columns; i++) {
+            eetg_view_cell_clear(&cells[i]);
+        }
+    }
+}
+
+static bool
+eetg_output_fits(const struct eetg_output *output, size_t cost)
+{
+    assert(output);
+
+    return (output->byte_budget == 0)
+           || ((output->nr_written + cost) <= output->byte_budget);
+}
+
+/*
+ * Return the number of bytes of the sequence scrolling a region of the
+ * terminal by the given distance.
+ */
+static size_t
+eetg_get_scroll_cost(int top, int bottom, int distance)
+{
+    size_t cost;
+
+    cost = sizeof(EETG_CSI ";r" EETG_CSI "T" EETG_CSI "r") - 1
+           + eetg_count_digits(top + 1) + eetg_count_digits(bottom + 1);
+
+    if ((distance > 1) || (distance < -1)) {
+        cost += eetg_count_digits((distance > 0) ? distance : -distance);
+    }
+
+    return cost;
+}
+
+/*
+ * Scroll the rows of the given region of the terminal, down (positive
+ * distance) or up (negative distance), with a temporary scrolling region.
+ * The terminal resets the cursor position when the scrolling region is
+ * set.
+ *
+ * The count is omitted when scrolling by one row.
+ */
+static void
+eetg_output_scroll(struct eetg_output *output, int top, int bottom,
+                   int distance)
+{
+    struct eetg_view *prev_view;
+    int count;
+    char str[48];
+
+    assert(output);
+    assert(top < bottom);
+    assert(distance != 0);
+
+    count = (distance > 0) ? distance : -distance;
+    assert(count <= (bottom - top));
+
+    if (count == 1) {
+        snprintf(str, sizeof(str),
+                 EETG_CSI "%d;%dr" EETG_CSI "%c" EETG_CSI "r",
+                 top + 1, bottom + 1, (distance > 0) ? 'T' : 'S');
+    } else {
+        snprintf(str, sizeof(str),
+                 EETG_CSI "%d;%dr" EETG_CSI "%d%c" EETG_CSI "r",
+                 top + 1, bottom + 1, count, (distance > 0) ? 'T' : 'S');
+    }
+
+    eetg_output_write_str(output, str);
+
+    output->cursor_row = 0;
+    output->cursor_column = 0;
+
+    prev_view = &output->prev_view;
+
+    if (distance > 0) {
+        memmove(&prev_view->rows[top + count], &prev_view->rows[top],
+                (bottom - top + 1 - count) * sizeof(prev_view->rows[0]));
+
+        for (int row = top; row < (top + count); row++) {
+            eetg_view_row_clear(&prev_view->rows[row]);
+        }
+    } else {
+        memmove(&prev_view->rows[top], &prev_view->rows[top + count],
+                (bottom - top + 1 - count) * sizeof(prev_view->rows[0]));
+
+        for (int row = bottom - count + 1; row <= bottom; row++) {
+            eetg_view_row_clear(&prev_view->rows[row]);
+        }
+    }
+
+    for (int row = top; row <= bottom; row++) {
+        eetg_span_extend(&output->pending[row], 0,
+                         eetg_output_get_nr_columns(output));
+    }
+}
+
+/*
+ * Scroll the whole screen by the vertical distance the viewport moved
+ * since the previous frame, if that's cheaper than redrawing its cells.
+ *
+ * Moving the viewport damages all cells, so that all rows are compared
+ * in full.
+ */
+static void
+eetg_output_render_pan(struct eetg_output *output)
+{
+    const struct eetg_view *view, *prev_view;
+    int nr_columns, nr_rows, distance;
+    long cost, scrolled_cost;
+
+    assert(output);
+
+    nr_columns = eetg_output_get_nr_columns(output);
+    nr_rows = eetg_output_get_nr_rows(output);
+
+    /*
+     * Moving the viewport down moves its content up on the screen.
+     */
+    distance = -output->pan_y;
+
+    if ((distance == 0) || (distance <= -nr_rows) || (distance >= nr_rows)) {
+        return;
+    }
+
+    view = &output->world->view;
+    prev_view = &output->prev_view;
+    cost = 0;
+    scrolled_cost = eetg_get_scroll_cost(0, nr_rows - 1, distance)
+                    + EETG_CURSOR_COST;
+
+    for (int row = 0; row < nr_rows; row++) {
+        const struct eetg_view_row *view_row = &view->rows[row];
+        int src = row - distance;
+
+        cost += eetg_view_row_get_update_cost(view_row, &prev_view->rows[row],
+                                              0, nr_columns);
+        scrolled_cost += eetg_view_row_get_update_cost(
+                             view_row,
+                             ((src < 0) || (src >= nr_rows))
+                             ? NULL
+                             : &prev_view->rows[src],
+                             0, nr_columns);
+    }
+
+    if ((scrolled_cost >= cost)
+        || !eetg_output_fits(output, eetg_get_scroll_cost(0, nr_rows - 1,
+                                                          distance))) {
+        return;
+    }
+
+    eetg_output_scroll(output, 0, nr_rows - 1, distance);
+}
+
+/*
+ * Detect a region of rows which moved up or down by one row since the
+ * previous frame, and scroll it on the terminal if that's cheaper than
+ * redrawing its cells.
+ *
+ * The gain of scrolling a region is the sum of the gains of its rows,
+ * the row entering the region being blank, so that the best region is
+ * found by trying all region starts, and extending each one row by row.
+ */
+static void
+eetg_output_render_scroll(struct eetg_output *output)
+{
+    long gains[2][EETG_MAX_ROWS], blank_gains[EETG_MAX_ROWS];
+    long costs[EETG_MAX_ROWS];
+    int best_top, best_bottom, best_distance, nr_pending;
+    const struct eetg_view *view, *prev_view;
+    int nr_columns, nr_rows;
+    long best_gain, limit, total_cost;
+    size_t cost;
+
+    assert(output);
+
+    nr_columns = eetg_output_get_nr_columns(output);
+    nr_rows = eetg_output_get_nr_rows(output);
+    nr_pending = 0;
+
+    for (int row = 0; row < nr_rows; row++) {
+        if (!eetg_span_empty(&output->pending[row])) {
+            nr_pending++;
+        }
+    }
+
+    if (nr_pending < 2) {
+        return;
+    }
+
+    view = &output->world->view;
+    prev_view = &output->prev_view;
+    total_cost = 0;
+
+    /*
+     * Rows only differ from their previous version in their pending span.
+     */
+    for (int row = 0; row < nr_rows; row++) {
+        const struct eetg_span *span = &output->pending[row];
+
+        costs[row] = eetg_span_empty(span)
+                     ? 0
+                     : eetg_view_row_get_update_cost(&view->rows[row],
+                                                     &prev_view->rows[row],
+                                                     span->start, span->end);
+        total_cost += costs[row];
+    }
+
+    cost = sizeof(EETG_CSI "24;24r" EETG_CSI "T" EETG_CSI "r") - 1
+           + EETG_CURSOR_COST;
+
+    /*
+     * The gain of a row can't exceed its update cost, so that scrolling
+     * can't pay off if updating all rows is cheaper than scrolling.
+     */
+    if (total_cost <= (long)cost) {
+        return;
+    }
+
+    for (int row = 0; row < nr_rows; row++) {
+        const struct eetg_view_row *view_row = &view->rows[row];
+        long cost0 = costs[row];
+
+        blank_gains[row] = cost0
+                           - eetg_view_row_get_update_cost(view_row, NULL,
+                                                           0, nr_columns);
+        gains[0][row] = (row == 0)
+                        ? LONG_MIN
+                        : cost0 - eetg_view_row_get_update_cost(
+                                      view_row, &prev_view->rows[row - 1],
+                                      0, nr_columns);
+        gains[1][row] = (row == (nr_rows - 1))
+                        ? LONG_MIN
+                        : cost0 - eetg_view_row_get_update_cost(
+                                      view_row, &prev_view->rows[row + 1],
+                                      0, nr_columns);
+    }
+
+    best_gain = 0;
+    best_top = 0;
+    best_bottom = 0;
+    best_distance = 0;
+    limit = -(long)nr_rows * nr_columns;
+
+    for (int top = 0; top < (nr_rows - 1); top++) {
+        long down, up;
+
+        /*
+         * Scrolling down blanks the top row, and scrolling up blanks
+         * the bottom row.
+         */
+        down = blank_gains[top];
+        up = gains[1][top];
+
+        for (int bottom = top + 1; bottom < nr_rows; bottom++) {
+            long gain;
+
+            down += gains[0][bottom];
+            gain = up + blank_gains[bottom];
+
+            if (down > best_gain) {
+                best_gain = down;
+                best_top = top;
+                best_bottom = bottom;
+                best_distance = 1;
+            }
+
+            if (gain > best_gain) {
+                best_gain = gain;
+                best_top = top;
+                best_bottom = bottom;
+                best_distance = -1;
+            }
+
+            if (bottom < (nr_rows - 1)) {
+                up += gains[1][bottom];
+            }
+
+            if ((down < limit) && (up < limit)) {
+                break;
+            }
+        }
+    }
+
+    if ((best_distance == 0) || (best_gain <= (long)cost)
+        || !eetg_output_fits(output, cost)) {
+        return;
+    }
+
+    eetg_output_scroll(output, best_top, best_bottom, best_distance);
+}
+
+/*
+ * Return the number of bytes of the sequence shifting a row by the given
+ * distance.
+ */
+static size_t
+eetg_get_shift_cost(int distance)
+{
+    return sizeof(EETG_CSI "@") - 1
+           + eetg_count_digits((distance > 0) ? distance : -distance);
+}
+
+/*
+ * Return true if shifting a row by the given distance would push cells
+ * which aren't blank out of it.
+ *
+ * See eetg_output_render_shift().
+ */
+static bool
+eetg_output_shift_spills(const struct eetg_output *output, int row,
+                         int distance)
+{
+    const struct eetg_view_row *prev_view_row;
+    int nr_columns;
+
+    assert(output);
+
+    if (distance <= 0) {
+        return false;
+    }
+
+    nr_columns = eetg_output_get_nr_columns(output);
+    prev_view_row = &output->prev_view.rows[row];
+
+    for (int column = nr_columns - distance; column < nr_columns; column++) {
+        if (eetg_view_cell_get_c(&prev_view_row->columns[column]) != ' ') {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Return the number of bytes of the sequences deleting the cells which
+ * inserting characters at the given column would push out of a row, and
+ * moving the cursor back to that column.
+ */
+static size_t
+eetg_get_spill_cost(int row, int column, int nr_columns, int distance)
+{
+    assert(distance > 0);
+
+    return (2 * (sizeof(EETG_CSI ";H") - 1 + eetg_count_digits(row + 1)))
+           + eetg_count_digits(nr_columns - distance + 1)
+           + eetg_get_shift_cost(-distance)
+           + eetg_count_digits(column + 1);
+}
+
+/*
+ * Return the cost of updating a row from the given column by shifting it
+ * by the given distance first.
+ */
+static size_t
+eetg_output_get_shift_cost(const struct eetg_output *output, int row,
+                           int column, int distance)
+{
+    const struct eetg_view_row *prev_view_row;
+    struct eetg_view_row shifted_row;
+    int nr_columns;
+
+    assert(output);
+
+    nr_columns = eetg_output_get_nr_columns(output);
+    prev_view_row = &output->prev_view.rows[row];
+
+    shifted_row = *prev_view_row;
+    eetg_view_row_shift(&shifted_row, nr_columns, column, distance);
+
+    return eetg_output_get_update_cost(output, row, column,
+                                       output->current_color)
+           + eetg_get_shift_cost(distance)
+           + (eetg_output_shift_spills(output, row, distance)
+              ? eetg_get_spill_cost(row, column, nr_columns, distance)
+              : 0)
+           + eetg_view_row_get_update_cost(&output->world->view.rows[row],
+                                           &shifted_row, column, nr_columns);
+}
+
+/*
+ * Detect a segment of a row which moved left or right since the previous
+ * frame, and shift it on the terminal if that's cheaper than redrawing
+ * its cells.
+ *
+ * Shifts start at the first changed column, where characters are either
+ * inserted, for a move to the right, or deleted, for a move to the left.
+ * Besides short distances, the horizontal distance the viewport moved is
+ * tried, since terminals can't portably scroll horizontally.
+ *
+ * Terminals may be wider than the viewport, and inserting characters
+ * pushes cells past its right edge, where they would remain. Cells about
+ * to be pushed out which aren't blank are therefore deleted first, so
+ * that cells right of the viewport remain blank, which also keeps
+ * deleting characters and scrolling rows correct there.
+ */
+static void
+eetg_output_render_shift(struct eetg_output *output, int row)
+{
+    struct eetg_view_row *view_row, *prev_view_row;
+    const struct eetg_span *span;
+    int nr_columns, column, best_distance, pan_distance;
+    size_t best_cost, cost;
+    char str[32];
+    bool spills;
+
+    assert(output);
+
+    nr_columns = eetg_output_get_nr_columns(output);
+    span = &output->pending[row];
+
+    if (eetg_span_empty(span)) {
+        return;
+    }
+
+    view_row = eetg_view_get_row(&output->world->view, row);
+    prev_view_row = eetg_view_get_row(&output->prev_view, row);
+
+    for (column = span->start; column < span->end; column++) {
+        if (!eetg_view_cell_equals(&view_row->columns[column],
+                                   &prev_view_row->columns[column])) {
+            break;
+        }
+    }
+
+    if (column == span->end) {
+        return;
+    }
+
+    /*
+     * Cells before the first changed column are equal, and remain so
+     * when shifting, so only the cells from there are compared.
+     */
+    best_cost = eetg_view_row_get_update_cost(view_row, prev_view_row,
+                                              column, span->end);
+    best_distance = 0;
+
+    for (int distance = -EETG_MAX_SHIFT;
+         distance <= EETG_MAX_SHIFT;
+         distance++) {
+        if ((distance == 0) || (distance >= (nr_columns - column))) {
+            continue;
+        }
+
+        cost = eetg_output_get_shift_cost(output, row, column, distance);
+
+        if (cost < best_cost) {
+            best_cost = cost;
+            best_distance = distance;
+        }
+    }
+
+    /*
+     * Moving the viewport right moves its content left on the screen.
+     */
+    pan_distance = -output->pan_x;
+
+    if (((pan_distance < -EETG_MAX_SHIFT) || (pan_distance > EETG_MAX_SHIFT))
+        && (pan_distance > -(nr_columns - column))
+        && (pan_distance < (nr_columns - column))
+        && (eetg_output_get_shift_cost(output, row, column, pan_distance)
+            < best_cost)) {
+        best_distance = pan_distance;
+    }
+
+    if (best_distance == 0) {
+        return;
+    }
+
+    snprintf(str, sizeof(str), EETG_CSI "%d%c",
+             (best_distance > 0) ? best_distance : -best_distance,
+             (best_distance > 0) ? '@' : 'P');
+
+    cost = eetg_output_get_update_cost(output, row, column,
+                                       output->current_color)
+           + strlen(str);
+
+    spills = eetg_output_shift_spills(output, row, best_distance);
+
+    if (spills) {
+        cost += eetg_get_spill_cost(row, column, nr_columns, best_distance);
+    }
+
+    if (!eetg_output_fits(output, cost)) {
+        return;
+    }
+
+    if (spills) {
+        char spill_str[32];
+
+        snprintf(spill_str, sizeof(spill_str), EETG_CSI "%dP",
+                 best_distance);
+        eetg_output_set_cursor(output, row, nr_columns - best_distance);
+        eetg_output_write_str(output, spill_str);
+    }
+
+    eetg_output_set_cursor(output, row, column);
+    eetg_output_write_str(output, str);
+    eetg_view_row_shift(prev_view_row, nr_columns, column, best_distance);
+    eetg_span_extend(&output->pending[row], column, nr_columns);
+}
+
+/*
+ * Emit changed cells of the given priority, or all changed cells if
+ * priority is -1.
+ *
+ * The priority of a changed cell is the highest of the priorities of
+ * what it displays and what it is to display, so that erasing a moving
+ * object is as urgent as drawing it at its new position.
+ *
+ * Return false if the byte budget was exhausted.
+ */
+static bool
+eetg_output_render_delta_pass(struct eetg_output *output, int priority)
+{
+    int nr_rows;
+
+    assert(output);
+
+    nr_rows = eetg_output_get_nr_rows(output);
+
+    for (int row = 0; row < nr_rows; row++) {
+        struct eetg_view_row *view_row, *prev_view_row;
+        const struct eetg_span *span;
+
+        span = &output->pending[row];
+
+        if (eetg_span_empty(span)) {
+            continue;
+        }
+
+        view_row = eetg_view_get_row(&output->world->view, row);
+        prev_view_row = eetg_view_get_row(&output->prev_view, row);
+
+        for (int column = span->start; column < span->end; column++) {
+            struct eetg_view_cell *view_cell, *prev_view_cell;
+            int color, prev_color;
+            char c, prev_c;
+
+            view_cell = eetg_view_row_get_cell(view_row, column);
+            color = eetg_view_cell_get_color(view_cell);
+            c = eetg_view_cell_get_c(view_cell);
+
+            prev_view_cell = eetg_view_row_get_cell(prev_view_row, column);
+            prev_color = eetg_view_cell_get_color(prev_view_cell);
+            prev_c = eetg_view_cell_get_c(prev_view_cell);
+
+            if ((color == prev_color) && (c == prev_c)) {
+                continue;
+            }
+
+            if ((priority >= 0)
+                && (eetg_view_cell_get_update_priority(view_cell,
+                                                       prev_view_cell)
+                    != priority)) {
+                continue;
+            }
+
+            if (!eetg_output_update_cell(output, row, column,
+                                         view_cell, prev_view_cell)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static void
+eetg_output_render_delta(struct eetg_output *output)
+{
+    int nr_rows;
+
+    assert(output);
+
+    nr_rows = eetg_output_get_nr_rows(output);
+
+    /*
+     * Move blocks of cells on the terminal first, then only emit the
+     * cells which still differ.
+     */
+    eetg_output_render_pan(output);
+    eetg_output_render_scroll(output);
+
+    for (int row = 0; row < nr_rows; row++) {
+        eetg_output_render_shift(output, row);
+    }
+
+    if (output->byte_budget == 0) {
+        eetg_output_render_delta_pass(output, -1);
+    } else {
+        for (int priority = EETG_NR_PRIORITIES - 1;
+             priority >= 0;
+             priority--) {
+            bool done;
+
+            done = eetg_output_render_delta_pass(output, priority);
+
+            if (!done) {
+                /*
+                 * Keep the pending spans so that deferred cells are
+                 * compared again on the next frame.
+                 */
+                return;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(output->pending); i++) {
+        eetg_span_init(&output->pending[i]);
+    }
+}
+
+static bool
+eetg_encoding_append(struct eetg_encoding *encoding,
+                     const char *data, size_t size)
+{
+    assert(encoding);
+
+    if ((encoding->size + size) > encoding->capacity) {
+        return false;
+    }
+
+    memcpy(&encoding->buffer[encoding->size], data, size);
+    encoding->size += size;
+    return true;
+}
+
+static bool
+eetg_encoding_append_str(struct eetg_encoding *encoding, const char *str)
+{
+    return eetg_encoding_append(encoding, str, strlen(str));
+}
+
+/*
+ * Build the encoding of an object, at its current position.
+ *
+ * Return false if the encoding doesn't fit in its buffer.
+ */
+static bool
+eetg_object_encode(struct eetg_object *object)
+{
+    const struct eetg_world *world;
+    struct eetg_encoding *encoding;
+    const struct eetg_sprite *sprite;
+    int x, y, nr_columns, nr_rows;
+    char str[32];
+
+    assert(object);
+    assert(!object->is_compound);
+
+    world = eetg_object_get_world(object);
+    nr_columns = eetg_world_get_viewport_nr_columns(world);
+    nr_rows = eetg_world_get_viewport_nr_rows(world);
+    encoding = object->encoding;
+    sprite = object->sprite;
+    x = eetg_object_get_origin_x(object) - world->viewport.x;
+    y = eetg_object_get_origin_y(object) - world->viewport.y;
+
+    encoding->size = 0;
+    encoding->x = x;
+    encoding->y = y;
+    encoding->valid = true;
+
+    snprintf(str, sizeof(str), EETG_CSI "%d;%dm",
+             eetg_convert_fg_color(object->color),
+             eetg_convert_bg_color(EETG_BG_COLOR));
+
+    if (!eetg_encoding_append_str(encoding, str)) {
+        return false;
+    }
+
+    for (int obj_row = 0; obj_row < object->height; obj_row++) {
+        const struct eetg_sprite_run *run, *end;
+        const char *line;
+        int row, cursor;
+
+        row = y + obj_row;
+
+        if ((row < 0) || (row >= nr_rows)) {
+            continue;
+        }
+
+        line = &sprite->text[sprite->row_offsets[obj_row]];
+        run = &sprite->runs[sprite->row_runs[obj_row]];
+        end = &sprite->runs[sprite->row_runs[obj_row + 1]];
+
+        /*
+         * Column of the cursor, or -1 until the first cell of the row.
+         */
+        cursor = -1;
+
+        for (; run < end; run++) {
+            for (int i = run->column; i < (run->column + run->length); i++) {
+                int column = x + i;
+
+                if ((column < 0) || (column >= nr_columns)
+                    || (object->mask
+                        && !eetg_mask_is_live(object->mask, i, obj_row))) {
+                    continue;
+                }
+
+                if (cursor == -1) {
+                    snprintf(str, sizeof(str), EETG_CSI "%d;%dH",
+                             row + 1, column + 1);
+                } else if (column != cursor) {
+                    snprintf(str, sizeof(str), EETG_CSI "%dC",
+                             column - cursor);
+                } else {
+                    str[0] = '\0';
+                }
+
+                if (!eetg_encoding_append_str(encoding, str)
+                    || !eetg_encoding_append(encoding, &line[i], 1)) {
+                    return false;
+                }
+
+                cursor = column + 1;
+            }
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Queue the encoding of an object, rebuilt if stale, and render the
+ * object into the previous view, limited to the given spans covering
+ * the whole world, so that it reflects the screen.
+ */
+static void
+eetg_output_repaint_object(struct eetg_output *output,
+                           struct eetg_object *object,
+                           const struct eetg_span *spans,
+                           struct eetg_buffer *buffers, size_t *nr_buffers)
+{
+    const struct eetg_viewport *viewport;
+    struct eetg_encoding *encoding;
+
+    assert(output);
+    assert(object);
+
+    viewport = &output->world->viewport;
+
+    if (eetg_viewport_excludes(viewport, eetg_object_get_x(object),
+                               eetg_object_get_y(object),
+                               object->width, object->height)) {
+        return;
+    }
+
+    if (object->is_compound) {
+        for (struct eetg_object *member = object->members;
+             member;
+             member = member->next) {
+            eetg_output_repaint_object(output, member, spans,
+                                       buffers, nr_buffers);
+        }
+
+        return;
+    }
+
+    encoding = object->encoding;
+
+    if (!encoding) {
+        return;
+    }
+
+    /*
+     * Encodings are built at screen coordinates.
+     */
+    if (!encoding->valid
+        || (encoding->x != (eetg_object_get_origin_x(object) - viewport->x))
+        || (encoding->y != (eetg_object_get_origin_y(object) - viewport->y))) {
+        if (!eetg_object_encode(object)) {
+            encoding->valid = false;
+            return;
+        }
+    }
+
+    if (*nr_buffers == EETG_MAX_BUFFERS) {
+        eetg_output_writev(output, buffers, *nr_buffers);
+        *nr_buffers = 0;
+    }
+
+    buffers[*nr_buffers].data = encoding->buffer;
+    buffers[*nr_buffers].size = encoding->size;
+    (*nr_buffers)++;
+
+    eetg_object_render(object, viewport, &output->prev_view, spans);
+}
+
+/*
+ * Write the encodings of the objects of a world, in compositing order.
+ *
+ * The previous view must be blank.
+ */
+static void
+eetg_output_repaint_objects(struct eetg_output *output)
+{
+    struct eetg_buffer buffers[EETG_MAX_BUFFERS];
+    const struct eetg_object_table *table;
+    struct eetg_span spans[EETG_MAX_ROWS];
+    size_t nr_buffers;
+
+    assert(output);
+
+    table = &output->world->objects;
+    nr_buffers = 0;
+
+    eetg_world_init_spans(output->world, spans);
+
+    /*
+     * Static objects are composited below the others.
+     */
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = table->nr_objects - 1; i >= 0; i--) {
+            if (table->is_static[i] == (pass == 0)) {
+                eetg_output_repaint_object(output, table->objects[i], spans,
+                                           buffers, &nr_buffers);
+            }
+        }
+    }
+
+    eetg_output_writev(output, buffers, nr_buffers);
+
+    if (nr_buffers != 0) {
+        output->cursor_row = -1;
+        output->cursor_column = -1;
+        output->current_color = -1;
+    }
+}
+
+static void
+eetg_output_render_sync(struct eetg_output *output)
+{
+    int nr_columns, nr_rows;
+
+    assert(output);
+
+    nr_columns = eetg_output_get_nr_columns(output);
+    nr_rows = eetg_output_get_nr_rows(output);
+
+    if (!output->in_session) {
+        eetg_output_write_str(output, EETG_CSI "?25l"); /* cursor invisible */
+    }
+
+    eetg_output_set_color(output, EETG_FG_COLOR, true);
+    eetg_output_write_str(output, EETG_CSI "2J"); /* clear screen */
+    eetg_output_set_cursor(output, 0, 0);
+
+    if (output->byte_budget != 0) {
+        /*
+         * The screen is now blank. Let the delta renderer repaint it
+         * progressively, within what remains of the budget.
+         */
+        eetg_view_clear(&output->prev_view, nr_rows);
+
+        for (int i = 0; i < nr_rows; i++) {
+            eetg_span_extend(&output->pending[i], 0, nr_columns);
+        }
+
+        eetg_output_render_delta(output);
+        return;
+    }
+
+    /*
+     * Write the encoded objects first, then the cells they don't
+     * display, e.g. those of other objects, or covered by them.
+     */
+    eetg_view_clear(&output->prev_view, nr_rows);
+    eetg_output_repaint_objects(output);
+
+    for (int row = 0; row < nr_rows; row++) {
+        struct eetg_view_row *view_row, *prev_view_row;
+
+        view_row = eetg_view_get_row(&output->world->view, row);
+        prev_view_row = eetg_view_get_row(&output->prev_view, row);
+
+        for (int column = 0; column < nr_columns; column++) {
+            struct eetg_view_cell *view_cell, *prev_view_cell;
+            int color;
+            char c;
+
+            view_cell = eetg_view_row_get_cell(view_row, column);
+            prev_view_cell = eetg_view_row_get_cell(prev_view_row, column);
+            color = eetg_view_cell_get_color(view_cell);
+            c = eetg_view_cell_get_c(view_cell);
+
+            if (eetg_view_cell_equals(view_cell, prev_view_cell)
+                || ((c == ' ')
+                    && (eetg_view_cell_get_c(prev_view_cell) == ' '))) {
+                continue;
+            }
+
+            eetg_output_set_cursor(output, row, column);
+            eetg_output_set_color(output, color, false);
+            eetg_output_write_char(output, c);
+        }
+    }
+
+    output->prev_view = output->world->view;
+
+    for (size_t i = 0; i < ARRAY_SIZE(output->pending); i++) {
+        eetg_span_init(&output->pending[i]);
+    }
+}
+
+void
+eetg_output_set_writev_fn(struct eetg_output *output,
+                          eetg_writev_fn writev_fn)
+{
+    assert(output);
+
+    output->writev_fn = writev_fn;
+}
+
+void
+eetg_output_set_span_fn(struct eetg_output *output,
+                        eetg_span_fn span_fn, void *arg)
+{
+    assert(output);
+
+    output->span_fn = span_fn;
+    output->span_fn_arg = arg;
+}
+
+void
+eetg_output_set_byte_budget(struct eetg_output *output, size_t budget)
+{
+    assert(output);
+
+    output->byte_budget = budget;
+}
+
+void
+eetg_world_set_writev_fn(struct eetg_world *world, eetg_writev_fn writev_fn)
+{
+    assert(world);
+
+    eetg_output_set_writev_fn(&world->output, writev_fn);
+}
+
+void
+eetg_world_set_byte_budget(struct eetg_world *world, size_t budget)
+{
+    assert(world);
+
+    eetg_output_set_byte_budget(&world->output, budget);
+}
+
+static void
+eetg_world_render_base_view(struct eetg_world *world)
+{
+    const struct eetg_object_table *table;
+    struct eetg_span spans[EETG_MAX_ROWS];
+
+    assert(world);
+
+    table = &world->objects;
+
+    eetg_world_init_spans(world, spans);
+    eetg_view_clear(&world->base_view, world->viewport.nr_rows);
+
+    for (int i = table->nr_objects - 1; i >= 0; i--) {
+        if (table->is_static[i]
+            && eetg_object_table_is_visible(table, i, &world->viewport,
+                                            spans)) {
+            eetg_object_render(table->objects[i], &world->viewport,
+                               &world->base_view, spans);
+        }
+    }
+
+    world->base_view_valid = true;
+}
+
+/*
+ * Composite the damaged areas of the view.
+ *
+ * Damaged spans are restored from the base view, after which non-static
+ * objects are rendered over them, from the last one in the table, unless
+ * they're outside the damaged spans. They're then added to the pending
+ * spans, which limit the comparison with the previous view.
+ */
+static void
+eetg_world_compose(struct eetg_world *world)
+{
+    const struct eetg_object_table *table;
+
+    assert(world);
+
+    table = &world->objects;
+
+    if (!world->base_view_valid) {
+        eetg_world_render_base_view(world);
+    }
+
+    for (int row = 0; row < world->viewport.nr_rows; row++) {
+        const struct eetg_span *span;
+        struct eetg_view_row *view_row, *base_view_row;
+
+        span = &world->damage[row];
+
+        if (eetg_span_empty(span)) {
+            continue;
+        }
+
+        view_row = eetg_view_get_row(&world->view, row);
+        base_view_row = eetg_view_get_row(&world->base_view, row);
+
+        memcpy(eetg_view_row_get_cell(view_row, span->start),
+               eetg_view_row_get_cell(base_view_row, span->start),
+               (span->end - span->start) * sizeof(struct eetg_view_cell));
+    }
+
+    for (int i = table->nr_objects - 1; i >= 0; i--) {
+        if (!table->is_static[i]
+            && eetg_object_table_is_visible(table, i, &world->viewport,
+                                            world->damage)) {
+            eetg_object_render(table->objects[i], &world->viewport,
+                               &world->view, world->damage);
+        }
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(world->damage); i++) {
+        struct eetg_span *span = &world->damage[i];
+
+        if (eetg_span_empty(span)) {
+            continue;
+        }
+
+        for (struct eetg_output *output = &world->output;
+             output;
+             output = output->next) {
+            eetg_span_extend(&output->pending[i], span->start, span->end);
+        }
+
+        eetg_span_init(span);
+    }
+}
+
+static void
+eetg_output_invalidate(struct eetg_output *output)
+{
+    assert(output);
+
+    output->cursor_row = -1;
+    output->cursor_column = -1;
+    output->current_color = -1;
+}
+
+void
+eetg_world_invalidate(struct eetg_world *world)
+{
+    assert(world);
+
+    for (struct eetg_output *output = &world->output;
+         output;
+         output = output->next) {
+        eetg_output_invalidate(output);
+        output->sync_pending = true;
+    }
+
+    world->base_view_valid = false;
+    eetg_world_damage_all(world);
+}
+
+/*
+ * Copy the simulation state of a world, i.e. everything but its views
+ * and outputs.
+ */
+static void
+eetg_world_copy_state(struct eetg_world *world, const struct eetg_world *src)
+{
+    assert(world);
+    assert(src);
+
+    world->handle_collision_fn = src->handle_collision_fn;
+    world->handle_collision_fn_arg = src->handle_collision_fn_arg;
+    world->objects = src->objects;
+    world->viewport = src->viewport;
+    world->nr_columns = src->nr_columns;
+    world->nr_rows = src->nr_rows;
+    world->rand_next = src->rand_next;
+}
+
+void
+eetg_world_save(const struct eetg_world *world, struct eetg_world *dest)
+{
+    eetg_world_copy_state(dest, world);
+}
+
+void
+eetg_world_restore(struct eetg_world *world, const struct eetg_world *src)
+{
+    assert(world);
+    assert(src);
+    assert(world->viewport.nr_columns == src->viewport.nr_columns);
+    assert(world->viewport.nr_rows == src->viewport.nr_rows);
+
+    eetg_world_copy_state(world, src);
+    eetg_world_invalidate(world);
+}
+
+int
+eetg_world_rand(struct eetg_world *world)
+{
+    assert(world);
+
+    world->rand_next = (world->rand_next * 1103515245) + 12345;
+    return (world->rand_next / 65536) % (EETG_RAND_MAX + 1);
+}
+
+uint32_t
+eetg_hash(uint32_t hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = data;
+
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 16777619U;
+    }
+
+    return hash;
+}
+
+uint32_t
+eetg_world_hash(const struct eetg_world *world, uint32_t hash)
+{
+    const struct eetg_object_table *table;
+
+    assert(world);
+
+    table = &world->objects;
+
+    hash = eetg_hash(hash, &world->rand_next, sizeof(world->rand_next));
+    hash = eetg_hash(hash, &table->nr_objects, sizeof(table->nr_objects));
+    hash = eetg_hash(hash, table->x, table->nr_objects * sizeof(table->x[0]));
+    hash = eetg_hash(hash, table->y, table->nr_objects * sizeof(table->y[0]));
+    hash = eetg_hash(hash, table->width,
+                     table->nr_objects * sizeof(table->width[0]));
+    hash = eetg_hash(hash, table->height,
+                     table->nr_objects * sizeof(table->height[0]));
+    hash = eetg_hash(hash, table->type, table->nr_objects);
+    hash = eetg_hash(hash, table->color, table->nr_objects);
+
+    return hash;
+}
+
+void
+eetg_output_get_cell(const struct eetg_output *output, int row, int column,
+                     char *c, int *color)
+{
+    const struct eetg_view_cell *view_cell;
+
+    assert(output);
+    assert(row >= 0);
+    assert(row < eetg_output_get_nr_rows(output));
+    assert(column >= 0);
+    assert(column < eetg_output_get_nr_columns(output));
+    assert(c);
+    assert(color);
+
+    view_cell = &output->prev_view.rows[row].columns[column];
+    *c = eetg_view_cell_get_c(view_cell);
+    *color = eetg_view_cell_get_color(view_cell);
+}
+
+void
+eetg_world_get_cell(const struct eetg_world *world, int row, int column,
+                    char *c, int *color)
+{
+    assert(world);
+
+    eetg_output_get_cell(&world->output, row, column, c, color);
+}
+
+void
+eetg_output_get_view_cell(const struct eetg_output *output,
+                          int row, int column, char *c, int *color)
+{
+    const struct eetg_view_cell *view_cell;
+
+    assert(output);
+    assert(row >= 0);
+    assert(row < eetg_output_get_nr_rows(output));
+    assert(column >= 0);
+    assert(column < eetg_output_get_nr_columns(output));
+    assert(c);
+    assert(color);
+
+    view_cell = &output->world->view.rows[row].columns[column];
+    *c = eetg_view_cell_get_c(view_cell);
+    *color = eetg_view_cell_get_color(view_cell);
+}
+
+bool
+eetg_output_is_row_pending(const struct eetg_output *output, int row)
+{
+    assert(output);
+    assert(row >= 0);
+    assert(row < eetg_output_get_nr_rows(output));
+
+    return !eetg_span_empty(&output->pending[row]);
+}
+
+/*
+ * Report the pending spans of an output to its span function, after
+ * which they're considered displayed.
+ */
+static void
+eetg_output_render_spans(struct eetg_output *output)
+{
+    int nr_columns, nr_rows;
+
+    assert(output);
+    assert(output->span_fn);
+
+    nr_columns = eetg_output_get_nr_columns(output);
+    nr_rows = eetg_output_get_nr_rows(output);
+
+    for (int row = 0; row < nr_rows; row++) {
+        struct eetg_view_row *view_row, *prev_view_row;
+        struct eetg_span *span;
+
+        span = &output->pending[row];
+
+        if (output->synced) {
+            eetg_span_extend(span, 0, nr_columns);
+        }
+
+        if (eetg_span_empty(span)) {
+            continue;
+        }
+
+        output->span_fn(output, row, span->start, span->end,
+                        output->span_fn_arg);
+
+        view_row = eetg_view_get_row(&output->world->view, row);
+        prev_view_row = eetg_view_get_row(&output->prev_view, row);
+        memcpy(eetg_view_row_get_cell(prev_view_row, span->start),
+               eetg_view_row_get_cell(view_row, span->start),
+               (span->end - span->start) * sizeof(struct eetg_view_cell));
+        eetg_span_init(span);
+    }
+}
+
+static void
+eetg_output_render(struct eetg_output *output, bool sync)
+{
+    assert(output);
+
+    if (output->span_fn) {
+        output->synced = sync || output->sync_pending;
+        output->sync_pending = false;
+        eetg_output_render_spans(output);
+        output->pan_x = 0;
+        output->pan_y = 0;
+        return;
+    }
+
+    output->nr_written = 0;
+    output->progressed = false;
+
+    /*
+     * The synchronized update sequences are accounted for upfront, so
+     * that they're included in the byte budget.
+     */
+    if (output->output_flags & EETG_OUTPUT_SYNC_UPDATE) {
+        output->frame_pending = true;
+        output->nr_written = sizeof(EETG_SYNC_UPDATE_START) - 1
+                             + sizeof(EETG_SYNC_UPDATE_END) - 1;
+    }
+
+    /*
+     * So is moving the cursor back home, which is done whatever the
+     * budget.
+     */
+    output->nr_written += EETG_HOME_COST;
+
+    /*
+     * Nothing else draws on the screen of a session, so periodic syncs
+     * are rendered as updates, and the screen is only cleared when the
+     * session starts or the output is invalidated.
+     */
+    if (output->in_session) {
+        sync = false;
+    }
+
+    output->synced = sync || output->sync_pending;
+
+    if (output->synced) {
+        output->sync_pending = false;
+        eetg_output_render_sync(output);
+    } else {
+        eetg_output_render_delta(output);
+    }
+
+    output->pan_x = 0;
+    output->pan_y = 0;
+
+    output->nr_written -= EETG_HOME_COST;
+    eetg_output_set_cursor(output, 0, 0);
+
+    output->frame_pending = false;
+
+    if (output->in_frame) {
+        output->in_frame = false;
+        eetg_output_emit(output, EETG_SYNC_UPDATE_END,
+                         sizeof(EETG_SYNC_UPDATE_END) - 1);
+    }
+}
+
+void
+eetg_world_render(struct eetg_world *world, bool sync)
+{
+    assert(world);
+
+    eetg_world_compose(world);
+
+    for (struct eetg_output *output = &world->output;
+         output;
+         output = output->next) {
+        eetg_output_render(output, sync);
+    }
+}
+
+bool
+eetg_output_is_synced(const struct eetg_output *output)
+{
+    assert(output);
+
+    return output->synced;
+}
+
+bool
+eetg_world_is_synced(const struct eetg_world *world)
+{
+    assert(world);
+
+    return eetg_output_is_synced(&world->output);
+}
+
+static void
+eetg_keyframe_write_str(eetg_write_fn write_fn, void *arg, const char *str)
+{
+    write_fn(str, strlen(str), arg);
+}
+
+static void
+eetg_keyframe_set_color(eetg_write_fn write_fn, void *arg, int color)
+{
+    char str[16];
+
+    snprintf(str, sizeof(str), EETG_CSI "%d;%dm",
+             eetg_convert_fg_color(color),
+             eetg_convert_bg_color(EETG_BG_COLOR));
+    eetg_keyframe_write_str(write_fn, arg, str);
+}
+
+static void
+eetg_keyframe_set_cursor(eetg_write_fn write_fn, void *arg,
+                         int row, int column)
+{
+    char str[32];
+
+    snprintf(str, sizeof(str), EETG_CSI "%d;%dH", row + 1, column + 1);
+    eetg_keyframe_write_str(write_fn, arg, str);
+}
+
+void
+eetg_output_write_keyframe(const struct eetg_output *output,
+                           eetg_write_fn write_fn, void *arg)
+{
+    int cursor_row, cursor_column, color, nr_columns, nr_rows;
+
+    assert(output);
+    assert(write_fn);
+
+    nr_columns = eetg_output_get_nr_columns(output);
+    nr_rows = eetg_output_get_nr_rows(output);
+
+    if (output->output_flags & EETG_OUTPUT_SYNC_UPDATE) {
+        eetg_keyframe_write_str(write_fn, arg, EETG_SYNC_UPDATE_START);
+    }
+
+    eetg_keyframe_write_str(write_fn, arg, EETG_CSI "?25l");
+    eetg_keyframe_set_color(write_fn, arg, EETG_FG_COLOR);
+    eetg_keyframe_write_str(write_fn, arg, EETG_CSI "2J");
+
+    cursor_row = -1;
+    cursor_column = -1;
+    color = EETG_FG_COLOR;
+
+    for (int row = 0; row < nr_rows; row++) {
+        const struct eetg_view_row *view_row;
+
+        view_row = &output->prev_view.rows[row];
+
+        for (int column = 0; column < nr_columns; column++) {
+            const struct eetg_view_cell *view_cell;
+            char c;
+
+            view_cell = &view_row->columns[column];
+            c = eetg_view_cell_get_c(view_cell);
+
+            if (c == ' ') {
+                continue;
+            }
+
+            if ((row != cursor_row) || (column != cursor_column)) {
+                eetg_keyframe_set_cursor(write_fn, arg, row, column);
+                cursor_row = row;
+                cursor_column = column;
+            }
+
+            if (eetg_view_cell_get_color(view_cell) != color) {
+                color = eetg_view_cell_get_color(view_cell);
+                eetg_keyframe_set_color(write_fn, arg, color);
+            }
+
+            write_fn(&c, sizeof(c), arg);
+
+            /*
+             * See eetg_output_write_char().
+             */
+            cursor_column++;
+
+            if (cursor_column == nr_columns) {
+                cursor_row = -1;
+                cursor_column = -1;
+            }
+        }
+    }
+
+    if (output->cursor_row != -1) {
+        eetg_keyframe_set_cursor(write_fn, arg,
+                                 output->cursor_row, output->cursor_column);
+    }
+
+    if ((output->current_color != -1) && (output->current_color != color)) {
+        eetg_keyframe_set_color(write_fn, arg, output->current_color);
+    }
+
+    if (output->output_flags & EETG_OUTPUT_SYNC_UPDATE) {
+        eetg_keyframe_write_str(write_fn, arg, EETG_SYNC_UPDATE_END);
+    }
+}
+
+void
+eetg_world_write_keyframe(const struct eetg_world *world,
+                          eetg_write_fn write_fn, void *arg)
+{
+    assert(world);
+
+    eetg_output_write_keyframe(&world->output, write_fn, arg);
+}
+
+void
+eetg_output_start_session(struct eetg_output *output, int flags)
+{
+    assert(output);
+    assert(!output->in_session);
+
+    output->output_flags = flags;
+    output->in_session = true;
+
+    if (flags & EETG_OUTPUT_ALT_SCREEN) {
+        eetg_output_write_str(output, EETG_CSI "?1049h");
+    }
+
+    eetg_output_write_str(output, EETG_CSI "?25l"); /* cursor invisible */
+
+    /*
+     * Switching screens may move the cursor, and clear the screen.
+     */
+    eetg_output_invalidate(output);
+    output->sync_pending = true;
+}
+
+void
+eetg_world_start_session(struct eetg_world *world, int flags)
+{
+    assert(world);
+
+    eetg_output_start_session(&world->output, flags);
+}
+
+void
+eetg_output_end_session(struct eetg_output *output)
+{
+    assert(output);
+    assert(output->in_session);
+
+    eetg_output_write_str(output, EETG_CSI "?25h"); /* cursor visible */
+
+    if (output->output_flags & EETG_OUTPUT_ALT_SCREEN) {
+        eetg_output_write_str(output, EETG_CSI "?1049l");
+    }
+
+    output->output_flags = 0;
+    output->in_session = false;
+}
+
+void
+eetg_world_end_session(struct eetg_world *world)
+{
+    assert(world);
+
+    eetg_output_end_session(&world->output);
+}
+
+static void
+eetg_sprite_compile(struct eetg_sprite *sprite)
+{
+    const char *text, *ptr;
+    int width, height, nr_runs;
+
+    assert(sprite);
+
+    text = sprite->text;
+    width = -1;
+    height = 0;
+    nr_runs = 0;
+
+    for (ptr = text; *ptr != '\0'; ptr++) {
+        const char *line = ptr;
+
+        assert(height < EETG_SPRITE_MAX_ROWS);
+        sprite->row_offsets[height] = line - text;
+        sprite->row_runs[height] = nr_runs;
+
+        while ((*ptr != '\n') && (*ptr != '\0')) {
+            const char *run;
+
+            if (*ptr == ' ') {
+                ptr++;
+                continue;
+            }
+
+            run = ptr;
+
+            do {
+                ptr++;
+            } while ((*ptr != ' ') && (*ptr != '\n') && (*ptr != '\0'));
+
+            assert(nr_runs < EETG_SPRITE_MAX_RUNS);
+            assert((ptr - run) <= UINT8_MAX);
+            sprite->runs[nr_runs].column = run - line;
+            sprite->runs[nr_runs].length = ptr - run;
+            nr_runs++;
+        }
+
+        if (width == -1) {
+            assert((ptr - line) <= INT8_MAX);
+            width = ptr - line;
+        }
+
+        assert((ptr - line) == width);
+        height++;
+
+        /*
+         * All lines, the last one included, end with a newline.
+         */
+        assert(*ptr == '\n');
+
+        if (*ptr == '\0') {
+            break;
+        }
+    }
+
+    assert(height > 0);
+
+    sprite->row_runs[height] = nr_runs;
+    sprite->width = width;
+    sprite->height = height;
+}
+
+void
+eetg_sprite_init(struct eetg_sprite *sprite, const char *text)
+{
+    assert(sprite);
+    assert(text);
+
+    sprite->text = text;
+    eetg_sprite_compile(sprite);
+}
+
+void
+eetg_sprite_update(struct eetg_sprite *sprite)
+{
+    int width, height;
+
+    assert(sprite);
+
+    width = sprite->width;
+    height = sprite->height;
+
+    eetg_sprite_compile(sprite);
+
+    assert(sprite->width == width);
+    assert(sprite->height == height);
+
+    (void)width;
+    (void)height;
+}
+
+const char *
+eetg_sprite_get_text(const struct eetg_sprite *sprite)
+{
+    assert(sprite);
+
+    return sprite->text;
+}
+
+bool
+eetg_sprite_is_empty(const struct eetg_sprite *sprite)
+{
+    assert(sprite);
+
+    return (sprite->row_runs[sprite->height] == 0);
+}
+
+static void
+eetg_object_load_sprite(struct eetg_object *object,
+                        const struct eetg_sprite *sprite)
+{
+    assert(object);
+    assert(sprite);
+
+    object->sprite = sprite;
+    object->width = sprite->width;
+    object->height = sprite->height;
+}
+
+void
+eetg_object_init(struct eetg_object *object, int type,
+                 const struct eetg_sprite *sprite)
+{
+    assert(object);
+
+    object->world = NULL;
+    object->next = NULL;
+    object->parent = NULL;
+    object->members = NULL;
+    object->mask = NULL;
+    object->encoding = NULL;
+    object->type = type;
+    object->x = 0;
+    object->y = 0;
+    object->extent_x = 0;
+    object->extent_y = 0;
+    object->color = EETG_FG_COLOR;
+    object->priority = EETG_PRIORITY_DEFAULT;
+    object->index = -1;
+    object->is_static = false;
+    object->is_compound = false;
+
+    eetg_object_load_sprite(object, sprite);
+}
+
+void
+eetg_object_init_compound(struct eetg_object *object, int type)
+{
+    assert(object);
+
+    object->world = NULL;
+    object->next = NULL;
+    object->parent = NULL;
+    object->members = NULL;
+    object->sprite = NULL;
+    object->mask = NULL;
+    object->encoding = NULL;
+    object->type = type;
+    object->x = 0;
+    object->y = 0;
+    object->color = EETG_FG_COLOR;
+    object->priority = EETG_PRIORITY_DEFAULT;
+    object->index = -1;
+    object->is_static = false;
+    object->is_compound = true;
+
+    eetg_object_update_extents(object);
+}
+
+void
+eetg_object_add_member(struct eetg_object *object,
+                       struct eetg_object *member, int x, int y)
+{
+    struct eetg_world *world;
+
+    assert(object);
+    assert(object->is_compound);
+    assert(!object->parent);
+    assert(member);
+    assert(!member->is_compound);
+    assert(!member->parent);
+    assert(!member->world);
+
+    member->next = object->members;
+    object->members = member;
+    member->parent = object;
+    member->x = x;
+    member->y = y;
+
+    eetg_object_update_extents(object);
+    eetg_object_damage(member);
+
+    world = object->world;
+
+    if (world) {
+        eetg_world_scan_collisions(world, member);
+    }
+}
+
+void
+eetg_object_remove_member(struct eetg_object *object,
+                          struct eetg_object *member)
+{
+    assert(object);
+    assert(member);
+    assert(member->parent == object);
+
+    eetg_object_damage(member);
+
+    if (object->members == member) {
+        object->members = member->next;
+    } else {
+        for (struct eetg_object *tmp = object->members;
+             tmp->next;
+             tmp = tmp->next) {
+            if (tmp->next == member) {
+                tmp->next = member->next;
+                break;
+            }
+        }
+    }
+
+    member->parent = NULL;
+    member->next = NULL;
+
+    eetg_object_update_extents(object);
+}
+
+void
+eetg_object_remove_members(struct eetg_object *object)
+{
+    struct eetg_object *member;
+
+    assert(object);
+    assert(object->is_compound);
+
+    eetg_object_damage(object);
+
+    member = object->members;
+
+    while (member) {
+        struct eetg_object *next = member->next;
+
+        member->parent = NULL;
+        member->next = NULL;
+        member = next;
+    }
+
+    object->members = NULL;
+
+    eetg_object_update_extents(object);
+}
+
+void
+eetg_object_set_sprite(struct eetg_object *object,
+                       const struct eetg_sprite *sprite)
+{
+    int width, height;
+
+    assert(object);
+    assert(!object->is_compound);
+    assert(!object->mask);
+
+    width = object->width;
+    height = object->height;
+
+    eetg_object_damage(object);
+    eetg_object_load_sprite(object, sprite);
+    eetg_object_invalidate_encoding(object);
+    eetg_object_sync(object);
+    eetg_object_damage(object);
+
+    if (object->parent
+        && ((object->width != width) || (object->height != height))) {
+        eetg_object_update_extents(object->parent);
+    }
+}
+
+void
+eetg_object_set_color(struct eetg_object *object, int color)
+{
+    assert(object);
+
+    object->color = color;
+    eetg_object_invalidate_encoding(object);
+    eetg_object_sync(object);
+    eetg_object_damage(object);
+}
+
+void
+eetg_object_set_mask(struct eetg_object *object, struct eetg_mask *mask)
+{
+    assert(object);
+    assert(!object->is_compound);
+
+    object->mask = mask;
+
+    if (mask) {
+        eetg_object_reset_mask(object);
+    } else {
+        eetg_object_invalidate_encoding(object);
+        eetg_object_damage(object);
+    }
+}
+
+void
+eetg_object_reset_mask(struct eetg_object *object)
+{
+    const struct eetg_sprite *sprite;
+    struct eetg_mask *mask;
+
+    assert(object);
+    assert(object->mask);
+
+    sprite = object->sprite;
+    mask = object->mask;
+
+    assert(sprite->width <= EETG_MASK_MAX_WIDTH);
+
+    mask->nr_live_cells = 0;
+
+    for (int row = 0; row < sprite->height; row++) {
+        const struct eetg_sprite_run *run, *end;
+
+        mask->rows[row] = 0;
+        run = &sprite->runs[sprite->row_runs[row]];
+        end = &sprite->runs[sprite->row_runs[row + 1]];
+
+        for (; run < end; run++) {
+            uint64_t bits;
+
+            bits = (run->length == 64)
+                   ? UINT64_MAX
+                   : ((UINT64_C(1) << run->length) - 1);
+            mask->rows[row] |= bits << run->column;
+            mask->nr_live_cells += run->length;
+        }
+    }
+
+    eetg_object_invalidate_encoding(object);
+    eetg_object_damage(object);
+}
+
+void
+eetg_object_clear_cell(struct eetg_object *object, int x, int y)
+{
+    struct eetg_world *world;
+    struct eetg_mask *mask;
+
+    assert(object);
+    assert(object->mask);
+    assert(eetg_object_get_cell(object, x, y) != -1);
+
+    mask = object->mask;
+    x -= eetg_object_get_origin_x(object);
+    y -= eetg_object_get_origin_y(object);
+
+    assert(eetg_mask_is_live(mask, x, y));
+    assert(mask->nr_live_cells > 0);
+
+    mask->rows[y] &= ~(UINT64_C(1) << x);
+    mask->nr_live_cells--;
+
+    eetg_object_invalidate_encoding(object);
+
+    world = eetg_object_get_world(object);
+
+    if (!world) {
+        return;
+    }
+
+    if (object->is_static || (object->parent && object->parent->is_static)) {
+        world->base_view_valid = false;
+    }
+
+    eetg_world_damage(world, eetg_object_get_origin_x(object) + x,
+                      eetg_object_get_origin_y(object) + y, 1, 1);
+}
+
+void
+eetg_object_set_priority(struct eetg_object *object, int priority)
+{
+    assert(object);
+    assert(priority >= 0);
+    assert(priority < EETG_NR_PRIORITIES);
+
+    object->priority = priority;
+    eetg_object_damage(object);
+}
+
+void
+eetg_object_set_static(struct eetg_object *object, bool is_static)
+{
+    assert(object);
+
+    eetg_object_damage(object);
+    object->is_static = is_static;
+    eetg_object_sync(object);
+    eetg_object_damage(object);
+}
+
+void
+eetg_encoding_init(struct eetg_encoding *encoding,
+                   char *buffer, size_t capacity)
+{
+    assert(encoding);
+    assert(buffer);
+    assert(capacity <= UINT16_MAX);
+
+    encoding->buffer = buffer;
+    encoding->capacity = capacity;
+    encoding->size = 0;
+    encoding->x = 0;
+    encoding->y = 0;
+    encoding->valid = false;
+}
+
+void
+eetg_object_set_encoding(struct eetg_object *object,
+                         struct eetg_encoding *encoding)
+{
+    assert(object);
+    assert(!object->is_compound);
+
+    object->encoding = encoding;
+    eetg_object_invalidate_encoding(object);
+}
+
+void
+eetg_object_invalidate(struct eetg_object *object)
+{
+    eetg_object_invalidate_encoding(object);
+    eetg_object_damage(object);
+}
+
+int
+eetg_object_get_type(const struct eetg_object *object)
+{
+    assert(object);
 
-static int
-eetg_convert_bg_color(int color)
+    return object->type;
+}
+
+const struct eetg_sprite *
+eetg_object_get_sprite(const struct eetg_object *object)
 {
-    return eetg_convert_fg_color(color) + 10;
+    assert(object);
+
+    return object->sprite;
 }
 
-static void
-eetg_world_set_color(struct eetg_world *world, int color, bool force)
+int
+eetg_object_get_x(const struct eetg_object *object)
 {
-    char str[16];
+    return eetg_object_get_origin_x(object) + object->extent_x;
+}
 
-    if ((color == world->current_color) && !force) {
-        return;
+int
+eetg_object_get_y(const struct eetg_object *object)
+{
+    return eetg_object_get_origin_y(object) + object->extent_y;
+}
+
+int
+eetg_object_get_width(const struct eetg_object *object)
+{
+    assert(object);
+
+    return object->width;
+}
+
+int
+eetg_object_get_height(const struct eetg_object *object)
+{
+    assert(object);
+
+    return object->height;
+}
+
+bool
+eetg_object_is_empty(const struct eetg_object *object)
+{
+    assert(object);
+
+    if (object->is_compound) {
+        return (object->members == NULL);
+    } else if (object->mask) {
+        return (object->mask->nr_live_cells == 0);
     }
 
-    snprintf(str, sizeof(str), EETG_CSI "%d;%dm",
-             eetg_convert_fg_color(color),
-             eetg_convert_bg_color(EETG_BG_COLOR));
+    return eetg_sprite_is_empty(object->sprite);
+}
+
+void
+eetg_object_move(struct eetg_object *object, int x, int y)
+{
+    struct eetg_world *world;
+
+    assert(object);
+
+    eetg_object_damage(object);
 
-    eetg_world_write_str(world, str);
+    object->x += x - eetg_object_get_x(object);
+    object->y += y - eetg_object_get_y(object);
+
+    if (object->parent) {
+        eetg_object_update_extents(object->parent);
+    } else {
+        eetg_object_sync(object);
+    }
+
+    eetg_object_damage(object);
+
+    world = eetg_object_get_world(object);
+
+    if (!world) {
+        return;
+    }
 
-    world->current_color = color;
+    if (object->is_compound) {
+        eetg_world_scan_compound_collisions(world, object);
+    } else {
+        eetg_world_scan_collisions(world, object);
+    }
 }
 
-static void
-eetg_world_write_char(struct eetg_world *world, char c)
+int
+eetg_object_get_cell(const struct eetg_object *object, int x, int y)
 {
-    eetg_world_write(world, &c, sizeof(c));
+    assert(object);
+    assert(!object->is_compound);
 
-    world->cursor_column++;
+    x -= eetg_object_get_origin_x(object);
+    y -= eetg_object_get_origin_y(object);
 
-    if (world->cursor_column == EETG_COLUMNS) {
-        if (world->cursor_row == EETG_ROWS) {
-            world->cursor_column = EETG_COLUMNS - 1;
-        } else {
-            world->cursor_column = 0;
-            world->cursor_row++;
-        }
+    if ((x < 0) || (x >= object->width) || (y < 0) || (y >= object->height)) {
+        return -1;
     }
+
+    return object->sprite->row_offsets[y] + x;
 }
 
-static void
-eetg_world_swap_views(struct eetg_world *world)
+struct eetg_world *
+eetg_object_get_world(const struct eetg_object *object)
 {
-    struct eetg_view *tmp;
+    assert(object);
 
-    assert(world);
+    return object->parent ? object->parent->world : object->world;
+}
+
+#define EETG_POOL_INDEX_NONE UINT16_MAX
 
-    tmp = world->view;
-    world->view = world->prev_view;
-    world->prev_view = tmp;
+static eetg_handle_t
+eetg_handle_build(uint16_t generation, uint16_t index)
+{
+    return ((eetg_handle_t)generation << 16) | index;
 }
 
-static void
-eetg_world_render_sync(struct eetg_world *world)
+static uint16_t
+eetg_handle_get_generation(eetg_handle_t handle)
 {
-    assert(world);
+    return handle >> 16;
+}
 
-    eetg_world_write_str(world, EETG_CSI "?25l"); /* cursor invisible */
-    eetg_world_set_color(world, EETG_FG_COLOR, true);
-    eetg_world_write_str(world, EETG_CSI "2J"); /* clear screen */
-    eetg_world_set_cursor(world, 0, 0);
+static uint16_t
+eetg_handle_get_index(eetg_handle_t handle)
+{
+    return handle & 0xffff;
+}
 
-    for (int row = 0; row < EETG_ROWS; row++) {
-        struct eetg_view_row *view_row;
+static struct eetg_pool_slot *
+eetg_pool_lookup(const struct eetg_pool *pool, eetg_handle_t handle)
+{
+    struct eetg_pool_slot *slot;
+    uint16_t index;
 
-        view_row = eetg_view_get_row(world->view, row);
+    assert(pool);
 
-        for (int column = 0; column < EETG_COLUMNS; column++) {
-            struct eetg_view_cell *view_cell;
-            int color;
-            char c;
+    index = eetg_handle_get_index(handle);
 
-            view_cell = eetg_view_row_get_cell(view_row, column);
-            color = eetg_view_cell_get_color(view_cell);
-            c = eetg_view_cell_get_c(view_cell);
+    if (index >= pool->capacity) {
+        return NULL;
+    }
 
-            if (c == ' ') {
-                continue;
-            }
+    slot = &pool->slots[index];
 
-            eetg_world_set_cursor(world, row, column);
-            eetg_world_set_color(world, color, false);
-            eetg_world_write_char(world, c);
-        }
+    if (!slot->allocated
+        || (slot->generation != eetg_handle_get_generation(handle))) {
+        return NULL;
     }
+
+    return slot;
 }
 
-static void
-eetg_world_render_delta(struct eetg_world *world)
+void
+eetg_pool_init(struct eetg_pool *pool, struct eetg_pool_slot *slots,
+               size_t capacity)
 {
-    assert(world);
+    assert(pool);
+    assert(slots);
+    assert(capacity != 0);
+    assert(capacity < EETG_POOL_INDEX_NONE);
 
-    for (int row = 0; row < EETG_ROWS; row++) {
-        struct eetg_view_row *view_row, *prev_view_row;
+    pool->slots = slots;
+    pool->capacity = capacity;
+    pool->nr_allocated = 0;
 
-        view_row = eetg_view_get_row(world->view, row);
-        prev_view_row = eetg_view_get_row(world->prev_view, row);
+    for (size_t i = 0; i < capacity; i++) {
+        struct eetg_pool_slot *slot = &slots[i];
 
-        for (int column = 0; column < EETG_COLUMNS; column++) {
-            struct eetg_view_cell *view_cell, *prev_view_cell;
-            int color, prev_color;
-            char c, prev_c;
+        slot->generation = 1;
+        slot->next_free = ((i + 1) == capacity) ? EETG_POOL_INDEX_NONE : i + 1;
+        slot->allocated = false;
+    }
 
-            view_cell = eetg_view_row_get_cell(view_row, column);
-            color = eetg_view_cell_get_color(view_cell);
-            c = eetg_view_cell_get_c(view_cell);
+    pool->free_head = 0;
+}
 
-            prev_view_cell = eetg_view_row_get_cell(prev_view_row, column);
-            prev_color = eetg_view_cell_get_color(prev_view_cell);
-            prev_c = eetg_view_cell_get_c(prev_view_cell);
+eetg_handle_t
+eetg_pool_spawn(struct eetg_pool *pool, int type,
+                const struct eetg_sprite *sprite)
+{
+    struct eetg_pool_slot *slot;
+    uint16_t index;
 
-            if ((color != prev_color) || (c != prev_c)) {
-                eetg_world_set_cursor(world, row, column);
-                eetg_world_set_color(world, color, false);
-                eetg_world_write_char(world, c);
-            }
-        }
+    assert(pool);
+
+    index = pool->free_head;
+
+    if (index == EETG_POOL_INDEX_NONE) {
+        return EETG_HANDLE_NULL;
     }
+
+    slot = &pool->slots[index];
+    assert(!slot->allocated);
+
+    pool->free_head = slot->next_free;
+    pool->nr_allocated++;
+
+    slot->allocated = true;
+    eetg_object_init(&slot->object, type, sprite);
+
+    return eetg_handle_build(slot->generation, index);
 }
 
 void
-eetg_world_render(struct eetg_world *world, bool sync)
+eetg_pool_despawn(struct eetg_pool *pool, eetg_handle_t handle)
 {
-    for (int row = 0; row < EETG_ROWS; row++) {
-        struct eetg_view_row *view_row;
+    struct eetg_pool_slot *slot;
+    struct eetg_world *world;
 
-        view_row = eetg_view_get_row(world->view, row);
+    slot = eetg_pool_lookup(pool, handle);
+    assert(slot);
 
-        for (int column = 0; column < EETG_COLUMNS; column++) {
-            struct eetg_view_cell *view_cell;
+    world = eetg_object_get_world(&slot->object);
 
-            view_cell = eetg_view_row_get_cell(view_row, column);
-            eetg_view_cell_set(view_cell, ' ', EETG_FG_COLOR);
-        }
+    if (world) {
+        eetg_world_remove(world, &slot->object);
     }
 
-    for (struct eetg_object *obj = world->objects; obj; obj = obj->next) {
-        eetg_object_render(obj, world->view);
-    }
+    slot->allocated = false;
+    slot->generation++;
 
-    if (sync) {
-        eetg_world_render_sync(world);
-    } else {
-        eetg_world_render_delta(world);
+    /*
+     * The null handle uses generation 0.
+     */
+    if (slot->generation == 0) {
+        slot->generation = 1;
     }
 
-    eetg_world_set_cursor(world, 0, 0);
-    eetg_world_swap_views(world);
+    slot->next_free = pool->free_head;
+    pool->free_head = eetg_handle_get_index(handle);
+
+    assert(pool->nr_allocated != 0);
+    pool->nr_allocated--;
 }
 
-void
-eetg_object_init(struct eetg_object *object, int type, const char *sprite)
+struct eetg_object *
+eetg_pool_get(const struct eetg_pool *pool, eetg_handle_t handle)
+{
+    struct eetg_pool_slot *slot;
+
+    slot = eetg_pool_lookup(pool, handle);
+
+    return slot ? &slot->object : NULL;
+}
+
+eetg_handle_t
+eetg_pool_get_handle(const struct eetg_pool *pool,
+                     const struct eetg_object *object)
 {
-    size_t width;
-    char *ptr;
+    const struct eetg_pool_slot *slot;
+    size_t index;
 
+    assert(pool);
     assert(object);
 
-    object->world = NULL;
-    object->next = NULL;
-    object->sprite = sprite;
-    object->type = type;
-    object->x = 0;
-    object->y = 0;
-    object->color = EETG_FG_COLOR;
+    slot = structof(object, struct eetg_pool_slot, object);
+    index = slot - pool->slots;
+
+    assert(index < pool->capacity);
+    assert(slot->allocated);
 
-    ptr = strchr(sprite, '\n');
-    assert(ptr);
+    return eetg_handle_build(slot->generation, index);
+}
 
-    width = ptr - sprite;
-    assert(width <= INT_MAX);
+size_t
+eetg_pool_get_nr_allocated(const struct eetg_pool *pool)
+{
+    assert(pool);
 
-    object->width = (int)width;
-    object->height = 1;
+    return pool->nr_allocated;
+}
 
-    for (;;) {
-        char *next;
+static bool
+eetg_timer_wheel_before(const struct eetg_timer *timer1,
+                        const struct eetg_timer *timer2)
+{
+    int32_t diff;
 
-        ptr = &ptr[1];
-        next = strchr(ptr, '\n');
+    diff = (int32_t)(timer1->expiry - timer2->expiry);
 
-        if (!next) {
-            break;
-        }
+    if (diff != 0) {
+        return (diff < 0);
+    }
 
-        width = next - ptr;
-        assert(width <= INT_MAX);
-        assert((int)width == object->width);
+    return (timer1->priority < timer2->priority);
+}
 
-        assert(object->height < INT_MAX);
-        object->height++;
+void
+eetg_timer_wheel_init(struct eetg_timer_wheel *wheel)
+{
+    assert(wheel);
 
-        ptr = next;
+    for (size_t i = 0; i < ARRAY_SIZE(wheel->buckets); i++) {
+        wheel->buckets[i] = NULL;
     }
+
+    wheel->tick = 0;
+    wheel->running = false;
 }
 
 void
-eetg_object_set_color(struct eetg_object *object, int color)
+eetg_timer_wheel_run(struct eetg_timer_wheel *wheel)
 {
-    assert(object);
+    struct eetg_timer **bucket;
 
-    object->color = color;
+    assert(wheel);
+    assert(!wheel->running);
+
+    wheel->tick++;
+    wheel->running = true;
+
+    bucket = &wheel->buckets[wheel->tick & (EETG_TIMER_WHEEL_SIZE - 1)];
+
+    /*
+     * Buckets are sorted, and timers may be scheduled or cancelled by the
+     * timers being run, so always restart from the head.
+     */
+    for (;;) {
+        struct eetg_timer *timer = *bucket;
+
+        if (!timer || (timer->expiry != wheel->tick)) {
+            break;
+        }
+
+        eetg_timer_cancel(timer);
+        timer->fn(timer->arg);
+    }
+
+    wheel->running = false;
 }
 
-int
-eetg_object_get_type(const struct eetg_object *object)
+uint32_t
+eetg_timer_wheel_get_tick(const struct eetg_timer_wheel *wheel)
 {
-    assert(object);
+    assert(wheel);
 
-    return object->type;
+    return wheel->tick;
 }
 
-const char *
-eetg_object_get_sprite(const struct eetg_object *object)
+void
+eetg_timer_init(struct eetg_timer *timer, eetg_timer_fn fn, void *arg,
+                int priority)
 {
-    assert(object);
+    assert(timer);
+    assert(fn);
+
+    timer->next = NULL;
+    timer->pprev = NULL;
+    timer->fn = fn;
+    timer->arg = arg;
+    timer->expiry = 0;
+    timer->priority = priority;
+}
 
-    return object->sprite;
+void
+eetg_timer_schedule(struct eetg_timer_wheel *wheel,
+                    struct eetg_timer *timer, uint32_t delay)
+{
+    struct eetg_timer **pprev;
+
+    assert(wheel);
+    assert(timer);
+    assert(delay <= INT32_MAX);
+
+    eetg_timer_cancel(timer);
+
+    if ((delay == 0) && !wheel->running) {
+        delay = 1;
+    }
+
+    timer->expiry = wheel->tick + delay;
+
+    pprev = &wheel->buckets[timer->expiry & (EETG_TIMER_WHEEL_SIZE - 1)];
+
+    while (*pprev && !eetg_timer_wheel_before(timer, *pprev)) {
+        pprev = &(*pprev)->next;
+    }
+
+    timer->next = *pprev;
+    timer->pprev = pprev;
+
+    if (timer->next) {
+        timer->next->pprev = &timer->next;
+    }
+
+    *pprev = timer;
 }
 
-int
-eetg_object_get_x(const struct eetg_object *object)
+void
+eetg_timer_cancel(struct eetg_timer *timer)
 {
-    assert(object);
+    assert(timer);
+
+    if (!timer->pprev) {
+        return;
+    }
 
-    return object->x;
+    *timer->pprev = timer->next;
+
+    if (timer->next) {
+        timer->next->pprev = timer->pprev;
+    }
+
+    timer->next = NULL;
+    timer->pprev = NULL;
 }
 
-int
-eetg_object_get_y(const struct eetg_object *object)
+bool
+eetg_timer_is_scheduled(const struct eetg_timer *timer)
 {
-    assert(object);
+    assert(timer);
 
-    return object->y;
+    return (timer->pprev != NULL);
 }
 
-int
-eetg_object_get_width(const struct eetg_object *object)
+void
+eetg_reloc_init(struct eetg_reloc *reloc, uintptr_t src, size_t size,
+                void *dest)
 {
-    assert(object);
+    assert(reloc);
 
-    return object->width;
+    reloc->start = src;
+    reloc->end = src + size;
+    reloc->dest = (uintptr_t)dest;
 }
 
-int
-eetg_object_get_height(const struct eetg_object *object)
+void
+eetg_reloc_apply(const struct eetg_reloc *reloc, void *ptr)
 {
-    assert(object);
+    uintptr_t *addr = ptr;
 
-    return object->height;
+    assert(reloc);
+    assert(addr);
+
+    if ((*addr >= reloc->start) && (*addr < reloc->end)) {
+        *addr = *addr - reloc->start + reloc->dest;
+    }
 }
 
-bool
-eetg_object_is_empty(const struct eetg_object *object)
+void
+eetg_world_relocate(struct eetg_world *world, const struct eetg_reloc *reloc)
 {
-    assert(object);
+    struct eetg_object_table *table;
+
+    assert(world);
 
-    for (const char *ptr = object->sprite; ptr; ptr++) {
-        char c = *ptr;
+    eetg_reloc_apply(reloc, &world->output.world);
+    eetg_reloc_apply(reloc, &world->output.next);
+    eetg_reloc_apply(reloc, &world->output.write_fn_arg);
+    eetg_reloc_apply(reloc, &world->output.span_fn_arg);
+    eetg_reloc_apply(reloc, &world->handle_collision_fn_arg);
 
-        if (c == '\0') {
-            break;
-        } else if ((c != ' ') && (c != '\n')) {
-            return false;
-        }
+    table = &world->objects;
+
+    for (int i = 0; i < table->nr_objects; i++) {
+        eetg_reloc_apply(reloc, &table->objects[i]);
     }
+}
 
-    return true;
+void
+eetg_sprite_relocate(struct eetg_sprite *sprite,
+                     const struct eetg_reloc *reloc)
+{
+    assert(sprite);
+
+    eetg_reloc_apply(reloc, &sprite->text);
 }
 
 void
-eetg_object_move(struct eetg_object *object, int x, int y)
+eetg_object_relocate(struct eetg_object *object,
+                     const struct eetg_reloc *reloc)
 {
     assert(object);
 
-    object->x = x;
-    object->y = y;
+    eetg_reloc_apply(reloc, &object->world);
+    eetg_reloc_apply(reloc, &object->next);
+    eetg_reloc_apply(reloc, &object->parent);
+    eetg_reloc_apply(reloc, &object->members);
+    eetg_reloc_apply(reloc, &object->sprite);
+    eetg_reloc_apply(reloc, &object->mask);
+    eetg_reloc_apply(reloc, &object->encoding);
+}
 
-    if (object->world) {
-        eetg_world_scan_collisions(object->world, object);
-    }
+void
+eetg_encoding_relocate(struct eetg_encoding *encoding,
+                       const struct eetg_reloc *reloc)
+{
+    assert(encoding);
+
+    eetg_reloc_apply(reloc, &encoding->buffer);
 }
 
-int
-eetg_object_get_cell(const struct eetg_object *object, int x, int y)
+void
+eetg_pool_relocate(struct eetg_pool *pool, const struct eetg_reloc *reloc)
 {
-    assert(object);
+    assert(pool);
 
-    x -= object->x;
-    y -= object->y;
+    eetg_reloc_apply(reloc, &pool->slots);
 
-    if ((x < 0) || (x >= object->width) || (y < 0) || (y >= object->height)) {
-        return -1;
+    for (size_t i = 0; i < pool->capacity; i++) {
+        eetg_object_relocate(&pool->slots[i].object, reloc);
     }
-
-    return ((object->width + 1) * y) + (x % object->width);
 }
 
-struct eetg_world *
-eetg_object_get_world(const struct eetg_object *object)
+void
+eetg_timer_wheel_relocate(struct eetg_timer_wheel *wheel,
+                          const struct eetg_reloc *reloc)
 {
-    assert(object);
+    assert(wheel);
 
-    return object->world;
+    for (size_t i = 0; i < ARRAY_SIZE(wheel->buckets); i++) {
+        eetg_reloc_apply(reloc, &wheel->buckets[i]);
+    }
 }
 
-void eetg_init_rand(unsigned int seed)
+void
+eetg_timer_relocate(struct eetg_timer *timer, const struct eetg_reloc *reloc)
 {
-    eetg_rand_next = seed;
+    assert(timer);
+
+    eetg_reloc_apply(reloc, &timer->next);
+    eetg_reloc_apply(reloc, &timer->pprev);
+    eetg_reloc_apply(reloc, &timer->arg);
 }
 
-int eetg_rand(void)
+void
+eetg_init_rand(unsigned int seed)
 {
-    eetg_rand_next = (eetg_rand_next * 1103515245) + 12345;
-    return (eetg_rand_next / 65536) % (EETG_RAND_MAX + 1);
+    eetg_rand_seed = seed;
 }
@@ -20,11 +20,64 @@
 #define EETG_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
+/*
+ * Default size of worlds and viewports, in cells.
+ */
 #define EETG_COLUMNS 80
 #define EETG_ROWS    24
 
+/*
+ * Size limits of viewports, which set the size of views.
+ *
+ * They default to 320x100, which covers large boards on wall displays,
+ * e.g. 300x100, at the cost of about 100 KB per view, and may be changed
+ * at build time, trading memory for larger screens. With EETG_FIXED_SIZE
+ * set to 1, e.g. for embedded builds, all worlds and viewports have the
+ * default size, which loops over views then use as a constant.
+ */
+#ifndef EETG_FIXED_SIZE
+#define EETG_FIXED_SIZE 0
+#endif
+
+#ifndef EETG_MAX_COLUMNS
+#if EETG_FIXED_SIZE
+#define EETG_MAX_COLUMNS EETG_COLUMNS
+#else
+#define EETG_MAX_COLUMNS 320
+#endif
+#endif
+
+#ifndef EETG_MAX_ROWS
+#if EETG_FIXED_SIZE
+#define EETG_MAX_ROWS EETG_ROWS
+#else
+#define EETG_MAX_ROWS 100
+#endif
+#endif
+
+#if (EETG_MAX_COLUMNS < EETG_COLUMNS) || (EETG_MAX_ROWS < EETG_ROWS)
+#error "size limits of viewports smaller than the default size"
+#endif
+
+#if EETG_FIXED_SIZE \
+    && ((EETG_MAX_COLUMNS != EETG_COLUMNS) || (EETG_MAX_ROWS != EETG_ROWS))
+#error "fixed-size viewports can't have other size limits"
+#endif
+
+/*
+ * Size limit of worlds, so that coordinates of objects on the whole world
+ * fit 16-bit integers.
+ */
+#define EETG_MAX_WORLD_SIZE 8192
+
+#if (EETG_MAX_COLUMNS > EETG_MAX_WORLD_SIZE) \
+    || (EETG_MAX_ROWS > EETG_MAX_WORLD_SIZE)
+#error "size limits of viewports larger than worlds"
+#endif
+
 #define EETG_RAND_MAX 32767
 
 #define EETG_COLOR_BLACK    0
@@ -36,69 +89,621 @@
 #define EETG_COLOR_CYAN     6
 #define EETG_COLOR_WHITE    7
 
+/*
+ * Rendering priorities.
+ *
+ * When a byte budget is set, changed cells are emitted from the highest
+ * priority down, and cells that don't fit are carried to the next frame.
+ */
+#define EETG_NR_PRIORITIES      4
+#define EETG_PRIORITY_DEFAULT   0
+
+/*
+ * Sprite capacity limits.
+ */
+#define EETG_SPRITE_MAX_ROWS    16
+#define EETG_SPRITE_MAX_RUNS    128
+
+/*
+ * Maximum width of sprites used with cell masks.
+ */
+#define EETG_MASK_MAX_WIDTH     64
+
+/*
+ * Output session flags.
+ */
+#define EETG_OUTPUT_SYNC_UPDATE 0x1
+#define EETG_OUTPUT_ALT_SCREEN  0x2
+
+/*
+ * Maximum number of objects in a world, not counting compound members.
+ */
+#define EETG_MAX_OBJECTS        64
+
+/*
+ * Maximum number of buffers passed at once to a vectored write function.
+ */
+#define EETG_MAX_BUFFERS        16
+
+/*
+ * Number of buckets in a timer wheel, must be a power of two.
+ */
+#define EETG_TIMER_WHEEL_SIZE   64
+
 struct eetg_world;
 
 struct eetg_object;
 
+struct eetg_output;
+
 typedef void (*eetg_write_fn)(const void *buffer, size_t size, void *arg);
 
+struct eetg_buffer {
+    const void *data;
+    size_t size;
+};
+
+typedef void (*eetg_writev_fn)(const struct eetg_buffer *buffers,
+                               size_t nr_buffers, void *arg);
+
+typedef void (*eetg_span_fn)(const struct eetg_output *output, int row,
+                             int start, int end, void *arg);
+
+typedef void (*eetg_timer_fn)(void *arg);
+
 typedef void (*eetg_handle_collision_fn)(struct eetg_object *object1,
                                          struct eetg_object *object2,
                                          int x, int y, void *arg);
 
+/*
+ * Run of opaque (non-space) characters in a sprite row.
+ */
+struct eetg_sprite_run {
+    uint8_t column;
+    uint8_t length;
+};
+
+/*
+ * Compiled sprite.
+ *
+ * The text of a sprite is made of rows of equal width, each terminated
+ * by a newline character. Spaces are transparent. Sprites are compiled
+ * into the offsets of their rows in the text, and the list of opaque runs
+ * of each row, so that rendering copies whole runs.
+ *
+ * Sprites may be shared by any number of objects.
+ */
+struct eetg_sprite {
+    const char *text;
+    int8_t width;
+    int8_t height;
+    uint16_t row_offsets[EETG_SPRITE_MAX_ROWS];
+    uint16_t row_runs[EETG_SPRITE_MAX_ROWS + 1];
+    struct eetg_sprite_run runs[EETG_SPRITE_MAX_RUNS];
+};
+
+/*
+ * Cell mask.
+ *
+ * A mask tracks the live cells of an object, one bit per cell, so that
+ * destructible objects may share a constant sprite. Only the opaque cells
+ * of the sprite are initially live. Dead cells are transparent.
+ */
+struct eetg_mask {
+    uint64_t rows[EETG_SPRITE_MAX_ROWS];
+    int nr_live_cells;
+};
+
+/*
+ * Object encoding.
+ *
+ * An encoding holds the bytes which display an object over a blank
+ * screen: its color, then for each row, the position of the first
+ * opaque cell, followed by the opaque cells, transparent ones being
+ * skipped by moving the cursor forward. Encodings are built by full
+ * repaints, and reused as long as the sprite, position, color and mask
+ * of their object don't change, so that repainting large objects only
+ * copies bytes. The buffer of an encoding is provided by the user.
+ */
+struct eetg_encoding {
+    char *buffer;
+    uint16_t capacity;
+    uint16_t size;
+    int16_t x;
+    int16_t y;
+    bool valid;
+};
+
+/*
+ * Object.
+ *
+ * An object is either a sprite, or a compound of member objects sharing
+ * a single position. The position of a member is relative to the origin
+ * of its compound, and the bounding box of a compound is the union of
+ * those of its members.
+ *
+ * The next pointer links the members of a compound. Objects in a world
+ * are referred to by their index in its object table.
+ */
 struct eetg_object {
     struct eetg_world *world;
     struct eetg_object *next;
-    const char *sprite;
+    struct eetg_object *parent;
+    struct eetg_object *members;
+    const struct eetg_sprite *sprite;
+    struct eetg_mask *mask;
+    struct eetg_encoding *encoding;
     int8_t color;
+    int8_t priority;
     int8_t type;
-    int8_t x;
-    int8_t y;
-    int8_t width;
-    int8_t height;
+    int16_t x;
+    int16_t y;
+    int16_t extent_x;
+    int16_t extent_y;
+    int16_t width;
+    int16_t height;
+    int16_t index;
+    bool is_static;
+    bool is_compound;
+};
+
+/*
+ * Object table.
+ *
+ * The bounding box, type, color and static flag of the objects of a
+ * world are mirrored into dense arrays, so that scans over all objects,
+ * such as the collision broad phase and culling, iterate over contiguous
+ * memory, and only dereference the objects that pass them.
+ *
+ * Objects are stored in insertion order, which removals preserve, and
+ * overlapping objects are stacked in that order, the first one on top.
+ */
+struct eetg_object_table {
+    struct eetg_object *objects[EETG_MAX_OBJECTS];
+    int16_t x[EETG_MAX_OBJECTS];
+    int16_t y[EETG_MAX_OBJECTS];
+    int16_t width[EETG_MAX_OBJECTS];
+    int16_t height[EETG_MAX_OBJECTS];
+    int8_t type[EETG_MAX_OBJECTS];
+    int8_t color[EETG_MAX_OBJECTS];
+    bool is_static[EETG_MAX_OBJECTS];
+    int nr_objects;
 };
 
 struct eetg_view_cell {
     char c;
     int8_t color;
+    int8_t priority;
 };
 
+/*
+ * View.
+ *
+ * Views are in screen coordinates, and sized for the largest viewports.
+ * Only the cells within the viewport of their world are used, the others
+ * remain blank.
+ */
 struct eetg_view_row {
-    struct eetg_view_cell columns[EETG_COLUMNS];
+    struct eetg_view_cell columns[EETG_MAX_COLUMNS];
 };
 
 struct eetg_view {
-    struct eetg_view_row rows[EETG_ROWS];
+    struct eetg_view_row rows[EETG_MAX_ROWS];
 };
 
-struct eetg_world {
+/*
+ * Range of columns in a row, end excluded.
+ *
+ * Spans are kept per view row, and those of the rows beyond the viewport
+ * of a world remain empty.
+ */
+struct eetg_span {
+    int16_t start;
+    int16_t end;
+};
+
+/*
+ * Viewport.
+ *
+ * A viewport is the area of a world displayed by its outputs, at screen
+ * coordinates (0, 0). Objects outside it aren't rendered.
+ */
+struct eetg_viewport {
+    int16_t x;
+    int16_t y;
+    int16_t nr_columns;
+    int16_t nr_rows;
+};
+
+/*
+ * Output.
+ *
+ * An output is a terminal on which a world is displayed. It tracks what
+ * it displays, the pending changes, the cursor position and color of the
+ * terminal, so that it's brought up to date from the view of its world
+ * independently of other outputs. A world has a main output, and may
+ * have additional outputs, all updated from the same view, which is
+ * composited once per frame.
+ */
+struct eetg_output {
+    struct eetg_world *world;
+    struct eetg_output *next;
     eetg_write_fn write_fn;
+    eetg_writev_fn writev_fn;
     void *write_fn_arg;
+    eetg_span_fn span_fn;
+    void *span_fn_arg;
+    struct eetg_view prev_view;
+    struct eetg_span pending[EETG_MAX_ROWS];
+    size_t byte_budget;
+    size_t nr_written;
+    bool progressed;
+    int output_flags;
+    bool in_session;
+    bool frame_pending;
+    bool in_frame;
+    bool sync_pending;
+    bool synced;
+    int16_t cursor_row;
+    int16_t cursor_column;
+    int16_t pan_x;
+    int16_t pan_y;
+    int8_t current_color;
+};
+
+struct eetg_world {
+    struct eetg_output output;
     eetg_handle_collision_fn handle_collision_fn;
     void *handle_collision_fn_arg;
-    struct eetg_object *objects;
-    struct eetg_view views[2];
-    struct eetg_view *view;
-    struct eetg_view *prev_view;
-    int8_t cursor_row;
-    int8_t cursor_column;
-    int8_t current_color;
+    struct eetg_object_table objects;
+    struct eetg_view view;
+    struct eetg_view base_view;
+    bool base_view_valid;
+    struct eetg_span damage[EETG_MAX_ROWS];
+    struct eetg_viewport viewport;
+    int16_t nr_columns;
+    int16_t nr_rows;
+    unsigned int rand_next;
 };
 
+/*
+ * Initialize a world of the default size, with the given write function
+ * for its main output.
+ */
 void eetg_world_init(struct eetg_world *world,
                      eetg_write_fn write_fn, void *arg);
+
+/*
+ * Change the size of a world, up to EETG_MAX_WORLD_SIZE.
+ *
+ * The viewport is moved to the top left corner of the world, and covers
+ * as much of it as the size limits of viewports allow. Objects are kept,
+ * and all outputs are fully repainted on the next frame. The size of
+ * fixed-size worlds can't change.
+ */
+void eetg_world_set_size(struct eetg_world *world,
+                         int nr_columns, int nr_rows);
+int eetg_world_get_nr_columns(const struct eetg_world *world);
+int eetg_world_get_nr_rows(const struct eetg_world *world);
+
+/*
+ * Change the size of the viewport of a world, within the size limits of
+ * viewports.
+ *
+ * All outputs are fully repainted on the next frame. The viewport of
+ * fixed-size worlds can't be resized.
+ */
+void eetg_world_resize_viewport(struct eetg_world *world,
+                                int nr_columns, int nr_rows);
+
+/*
+ * Move the viewport of a world, so that its top left corner is at the
+ * given world coordinates.
+ *
+ * The viewport may extend beyond the world. Outputs scroll the terminal
+ * where it's cheaper than repainting the cells which moved.
+ */
+void eetg_world_move_viewport(struct eetg_world *world, int x, int y);
+int eetg_world_get_viewport_x(const struct eetg_world *world);
+int eetg_world_get_viewport_y(const struct eetg_world *world);
+int eetg_world_get_viewport_nr_columns(const struct eetg_world *world);
+int eetg_world_get_viewport_nr_rows(const struct eetg_world *world);
 void eetg_world_clear(struct eetg_world *world);
 void eetg_world_register_collision_fn(struct eetg_world *world,
          eetg_handle_collision_fn handle_collision_fn, void *arg);
 void eetg_world_add(struct eetg_world *world, struct eetg_object *object,
                     int x, int y);
 void eetg_world_remove(struct eetg_world *world, struct eetg_object *object);
+
+/*
+ * Initialize an additional output, with the given write function.
+ */
+void eetg_output_init(struct eetg_output *output,
+                      eetg_write_fn write_fn, void *arg);
+
+/*
+ * Add/remove an additional output to/from a world.
+ *
+ * An output is fully repainted on the first frame after being added.
+ */
+void eetg_world_add_output(struct eetg_world *world,
+                           struct eetg_output *output);
+void eetg_world_remove_output(struct eetg_world *world,
+                              struct eetg_output *output);
+
+/*
+ * Return the main output of a world.
+ *
+ * World functions operating on an output apply to the main output.
+ */
+struct eetg_output *eetg_world_get_output(struct eetg_world *world);
+
+/*
+ * Set the maximum number of bytes emitted per rendered frame.
+ *
+ * A budget of 0 means unlimited. The budget applies to cell updates,
+ * to the sequences which open and close frames, and to those clearing
+ * the screen on syncs, and cells which don't fit are deferred to the
+ * following frames. So that the screen is eventually complete, however
+ * small the budget, each frame makes some progress, i.e. either clears
+ * the screen, or emits at least the highest priority changed cell.
+ */
+void eetg_output_set_byte_budget(struct eetg_output *output, size_t budget);
+void eetg_world_set_byte_budget(struct eetg_world *world, size_t budget);
+
+/*
+ * Set an optional vectored write function, called with the argument of
+ * the write function.
+ *
+ * Full repaints pass the encodings of objects at once to a vectored
+ * write function, or to the write function one after the other.
+ */
+void eetg_output_set_writev_fn(struct eetg_output *output,
+                               eetg_writev_fn writev_fn);
+void eetg_world_set_writev_fn(struct eetg_world *world,
+                              eetg_writev_fn writev_fn);
+
+/*
+ * Set an optional span function, to which an output reports the cells to
+ * update instead of writing terminal sequences.
+ *
+ * On each frame, the span function is called, in row order, for each row
+ * with cells which may have changed, and gets them with
+ * eetg_output_get_view_cell(), and those they replace with
+ * eetg_output_get_cell(). Full repaints report whole rows. Byte budgets
+ * and sessions don't apply to such outputs.
+ */
+void eetg_output_set_span_fn(struct eetg_output *output,
+                             eetg_span_fn span_fn, void *arg);
+
+/*
+ * Render a frame.
+ *
+ * The view is composited once, after which each output is updated,
+ * or fully repainted if sync is true. Outputs in a session are only
+ * fully repainted when the session starts or they're invalidated.
+ */
 void eetg_world_render(struct eetg_world *world, bool sync);
 
-void eetg_object_init(struct eetg_object *object, int type, const char *sprite);
+/*
+ * Return true if the last frame rendered by an output was a full
+ * repaint.
+ */
+bool eetg_output_is_synced(const struct eetg_output *output);
+bool eetg_world_is_synced(const struct eetg_world *world);
+
+/*
+ * Write the bytes which display what an output last displayed, with the
+ * given write function.
+ *
+ * The resulting keyframe brings a terminal in any state, e.g. a terminal
+ * connecting to a running game, to the state the following frames of the
+ * output expect, including the cursor position and color. It doesn't
+ * affect the output itself.
+ */
+void eetg_output_write_keyframe(const struct eetg_output *output,
+                                eetg_write_fn write_fn, void *arg);
+void eetg_world_write_keyframe(const struct eetg_world *world,
+                               eetg_write_fn write_fn, void *arg);
+
+/*
+ * Start/end an output session.
+ *
+ * Starting a session hides the cursor until the session ends. Depending
+ * on the given flags, the session also runs on the alternate screen,
+ * which preserves the content of the main screen, and frames are written
+ * between synchronized update sequences, so that the terminal paints
+ * them at once. Terminals which don't support these sequences ignore
+ * them, and display frames as they're received.
+ */
+void eetg_output_start_session(struct eetg_output *output, int flags);
+void eetg_output_end_session(struct eetg_output *output);
+void eetg_world_start_session(struct eetg_world *world, int flags);
+void eetg_world_end_session(struct eetg_world *world);
+
+/*
+ * Report that the state of the terminals is unknown.
+ *
+ * The cursor position and color of all outputs are set again on the
+ * next update, and the whole world is composited again. All outputs
+ * are fully repainted on the next render.
+ */
+void eetg_world_invalidate(struct eetg_world *world);
+
+/*
+ * Copy the state of a world, without its views and outputs, e.g. into a
+ * snapshot.
+ *
+ * The world copied into is only meant to be restored from.
+ */
+void eetg_world_save(const struct eetg_world *world, struct eetg_world *dest);
+
+/*
+ * Copy the state of a world into another, e.g. from a snapshot.
+ *
+ * The views and outputs of the world copied into are kept, and it's
+ * invalidated, so that its view is composited again. The viewports of
+ * both worlds must have the same size. Pointers to objects must then be
+ * relocated, as after a plain copy.
+ */
+void eetg_world_restore(struct eetg_world *world,
+                        const struct eetg_world *src);
+
+/*
+ * Return a pseudo-random number between 0 and EETG_RAND_MAX.
+ *
+ * Each world has its own generator, so that the sequence of a world only
+ * depends on its seed and its own use of the generator.
+ */
+int eetg_world_rand(struct eetg_world *world);
+
+/*
+ * Initial value of a hash.
+ */
+#define EETG_HASH_INIT 2166136261U
+
+/*
+ * Update a hash with the given bytes (FNV-1a).
+ */
+uint32_t eetg_hash(uint32_t hash, const void *data, size_t size);
+
+/*
+ * Update a hash with the state of a world, i.e. the state of its
+ * generator and the bounding box, type and color of its objects.
+ *
+ * Values are hashed in host byte order, so that hashes may only be
+ * compared between builds for the same architecture.
+ */
+uint32_t eetg_world_hash(const struct eetg_world *world, uint32_t hash);
+
+/*
+ * Get the character and color of a cell as last displayed by an output,
+ * at the given screen coordinates.
+ *
+ * Without a byte budget, this is the content of the view once rendered.
+ */
+void eetg_output_get_cell(const struct eetg_output *output,
+                          int row, int column, char *c, int *color);
+void eetg_world_get_cell(const struct eetg_world *world, int row, int column,
+                         char *c, int *color);
+
+/*
+ * Get the character and color of a cell of the view of the world of an
+ * output, as last composed, at the given screen coordinates.
+ */
+void eetg_output_get_view_cell(const struct eetg_output *output,
+                               int row, int column, char *c, int *color);
+
+/*
+ * Return true if cells of a row were deferred by the byte budget, in
+ * which case the row may not be displayed as in the view.
+ */
+bool eetg_output_is_row_pending(const struct eetg_output *output, int row);
+
+/*
+ * Compile a sprite.
+ *
+ * The text must remain valid as long as the sprite is used. If it is
+ * modified in place, the sprite must be updated, and objects using it
+ * invalidated.
+ */
+void eetg_sprite_init(struct eetg_sprite *sprite, const char *text);
+void eetg_sprite_update(struct eetg_sprite *sprite);
+const char *eetg_sprite_get_text(const struct eetg_sprite *sprite);
+bool eetg_sprite_is_empty(const struct eetg_sprite *sprite);
+
+void eetg_object_init(struct eetg_object *object, int type,
+                      const struct eetg_sprite *sprite);
+
+/*
+ * Initialize a compound object.
+ *
+ * A compound is moved, added to and removed from a world as a whole.
+ * Collisions are first checked against the bounding box of the compound,
+ * and only then against its members, which are the objects reported to
+ * the collision function. The position and size of a compound are those
+ * of the bounding box of its members.
+ */
+void eetg_object_init_compound(struct eetg_object *object, int type);
+
+/*
+ * Add/remove a member to/from a compound object.
+ *
+ * The position of a member is given relative to the origin of the
+ * compound. A member can't itself be a compound, and must not be part
+ * of a world on its own.
+ */
+void eetg_object_add_member(struct eetg_object *object,
+                            struct eetg_object *member, int x, int y);
+void eetg_object_remove_member(struct eetg_object *object,
+                               struct eetg_object *member);
+void eetg_object_remove_members(struct eetg_object *object);
+
 void eetg_object_set_color(struct eetg_object *object, int color);
+
+/*
+ * Set the cell mask of an object.
+ *
+ * The mask is reset so that all opaque cells of the sprite of the
+ * object are live. Passing NULL removes the mask.
+ */
+void eetg_object_set_mask(struct eetg_object *object, struct eetg_mask *mask);
+void eetg_object_reset_mask(struct eetg_object *object);
+
+/*
+ * Clear a live cell of an object with a mask.
+ *
+ * The given position is the absolute position of the cell. Clearing the
+ * last live cell makes the object empty.
+ */
+void eetg_object_clear_cell(struct eetg_object *object, int x, int y);
+
+/*
+ * Initialize an encoding, with the given buffer.
+ *
+ * Objects with an encoding larger than its buffer are repainted cell by
+ * cell.
+ */
+void eetg_encoding_init(struct eetg_encoding *encoding,
+                        char *buffer, size_t capacity);
+
+/*
+ * Set the encoding of an object, or remove it if NULL.
+ *
+ * Only objects which aren't compounds may have an encoding.
+ */
+void eetg_object_set_encoding(struct eetg_object *object,
+                              struct eetg_encoding *encoding);
+
+void eetg_object_set_priority(struct eetg_object *object, int priority);
+
+/*
+ * Change the sprite of an object.
+ */
+void eetg_object_set_sprite(struct eetg_object *object,
+                           const struct eetg_sprite *sprite);
+
+/*
+ * Mark an object as static.
+ *
+ * Static objects are composited once into a base view, from which
+ * damaged areas are restored, and are always displayed below non-static
+ * objects.
+ */
+void eetg_object_set_static(struct eetg_object *object, bool is_static);
+
+/*
+ * Report that the content of the sprite of an object has changed.
+ *
+ * Only the areas covered by objects which were added, removed, moved or
+ * changed are composited again on each frame. Sprites modified in place
+ * must be reported with this function.
+ */
+void eetg_object_invalidate(struct eetg_object *object);
+
 int eetg_object_get_type(const struct eetg_object *object);
-const char *eetg_object_get_sprite(const struct eetg_object *object);
+const struct eetg_sprite *eetg_object_get_sprite(
+    const struct eetg_object *object);
 int eetg_object_get_x(const struct eetg_object *object);
 int eetg_object_get_y(const struct eetg_object *object);
 int eetg_object_get_width(const struct eetg_object *object);
@@ -108,7 +713,184 @@ void eetg_object_move(struct eetg_object *object, int x, int y);
 int eetg_object_get_cell(const struct eetg_object *object, int x, int y);
 struct eetg_world *eetg_object_get_world(const struct eetg_object *object);
 
+/*
+ * Object handle.
+ *
+ * Handles are made of the index of an object in its pool, in the low
+ * 16 bits, and the generation of the slot, in the high 16 bits. The
+ * generation of a slot changes whenever its object is despawned, which
+ * makes stale handles invalid. The null handle is never valid.
+ */
+typedef uint32_t eetg_handle_t;
+
+#define EETG_HANDLE_NULL 0
+
+/*
+ * Pool slot.
+ */
+struct eetg_pool_slot {
+    struct eetg_object object;
+    uint16_t generation;
+    uint16_t next_free;
+    bool allocated;
+};
+
+/*
+ * Fixed-capacity object pool.
+ *
+ * Slots are provided by the user, and reused through a free list, so
+ * that spawning and despawning objects are constant-time operations
+ * which never allocate memory.
+ */
+struct eetg_pool {
+    struct eetg_pool_slot *slots;
+    uint16_t capacity;
+    uint16_t free_head;
+    uint16_t nr_allocated;
+};
+
+/*
+ * Initialize a pool, with the given slots.
+ *
+ * The capacity is limited to 65535 slots.
+ */
+void eetg_pool_init(struct eetg_pool *pool, struct eetg_pool_slot *slots,
+                    size_t capacity);
+
+/*
+ * Spawn an object.
+ *
+ * The object is initialized with the given type and sprite, but isn't
+ * added to any world. Return the null handle if the pool is full.
+ */
+eetg_handle_t eetg_pool_spawn(struct eetg_pool *pool, int type,
+                              const struct eetg_sprite *sprite);
+
+/*
+ * Despawn an object.
+ *
+ * The object is removed from its world, if any, and the handle, along
+ * with all its copies, become invalid.
+ */
+void eetg_pool_despawn(struct eetg_pool *pool, eetg_handle_t handle);
+
+/*
+ * Return the object referred to by a handle, or NULL if the handle is
+ * invalid.
+ */
+struct eetg_object *eetg_pool_get(const struct eetg_pool *pool,
+                                  eetg_handle_t handle);
+
+/*
+ * Return the handle of an object spawned from a pool.
+ */
+eetg_handle_t eetg_pool_get_handle(const struct eetg_pool *pool,
+                                   const struct eetg_object *object);
+
+size_t eetg_pool_get_nr_allocated(const struct eetg_pool *pool);
+
+/*
+ * Timer.
+ *
+ * Timers expire on a given tick of a timer wheel. Timers expiring on the
+ * same tick run in priority order, lowest first.
+ */
+struct eetg_timer {
+    struct eetg_timer *next;
+    struct eetg_timer **pprev;
+    eetg_timer_fn fn;
+    void *arg;
+    uint32_t expiry;
+    int8_t priority;
+};
+
+/*
+ * Hashed timer wheel.
+ *
+ * Timers are hashed on their expiry tick into a fixed number of buckets,
+ * kept sorted, so that scheduling, cancelling and running due timers
+ * don't depend on the total number of timers, as long as their delays
+ * are spread.
+ */
+struct eetg_timer_wheel {
+    struct eetg_timer *buckets[EETG_TIMER_WHEEL_SIZE];
+    uint32_t tick;
+    bool running;
+};
+
+void eetg_timer_wheel_init(struct eetg_timer_wheel *wheel);
+
+/*
+ * Advance the timer wheel by one tick, and run the timers expiring on
+ * that tick.
+ */
+void eetg_timer_wheel_run(struct eetg_timer_wheel *wheel);
+
+uint32_t eetg_timer_wheel_get_tick(const struct eetg_timer_wheel *wheel);
+
+void eetg_timer_init(struct eetg_timer *timer, eetg_timer_fn fn, void *arg,
+                     int priority);
+
+/*
+ * Schedule a timer to expire in the given number of ticks.
+ *
+ * A timer which is already scheduled is rescheduled. A delay of 0 makes
+ * the timer expire on the current tick if the wheel is running, in which
+ * case it runs after the timer calling this function, or on the next
+ * tick otherwise.
+ */
+void eetg_timer_schedule(struct eetg_timer_wheel *wheel,
+                         struct eetg_timer *timer, uint32_t delay);
+void eetg_timer_cancel(struct eetg_timer *timer);
+bool eetg_timer_is_scheduled(const struct eetg_timer *timer);
+
+/*
+ * Relocation context.
+ *
+ * Structures embedding engine objects contain pointers to themselves,
+ * and can't be copied as plain data. Instead, they're copied, after
+ * which the pointers of the copy which point into the source region
+ * are moved to the destination. Other pointers are left unchanged.
+ */
+struct eetg_reloc {
+    uintptr_t start;
+    uintptr_t end;
+    uintptr_t dest;
+};
+
+void eetg_reloc_init(struct eetg_reloc *reloc, uintptr_t src, size_t size,
+                     void *dest);
+
+/*
+ * Relocate a pointer, passed by address.
+ */
+void eetg_reloc_apply(const struct eetg_reloc *reloc, void *ptr);
+
+/*
+ * Relocate the pointers of engine structures.
+ *
+ * Relocating a world relocates the pointers of its object table and
+ * views, but not the objects themselves. Relocating a pool relocates
+ * its slots, including their objects.
+ */
+void eetg_world_relocate(struct eetg_world *world,
+                         const struct eetg_reloc *reloc);
+void eetg_sprite_relocate(struct eetg_sprite *sprite,
+                          const struct eetg_reloc *reloc);
+void eetg_object_relocate(struct eetg_object *object,
+                          const struct eetg_reloc *reloc);
+void eetg_pool_relocate(struct eetg_pool *pool,
+                        const struct eetg_reloc *reloc);
+void eetg_encoding_relocate(struct eetg_encoding *encoding,
+                            const struct eetg_reloc *reloc);
+void eetg_timer_wheel_relocate(struct eetg_timer_wheel *wheel,
+                               const struct eetg_reloc *reloc);
+void eetg_timer_relocate(struct eetg_timer *timer,
+                         const struct eetg_reloc *reloc);
+
+/*
+ * Set the seed of the generators of worlds initialized afterwards.
+ */
 void eetg_init_rand(unsigned int seed);
-int eetg_rand(void);
 
 #endif /* EETG_H */
@@ -31,11 +31,16 @@
 
 #define EI_ALIEN_STARTING_ROW 3
 
+/*
+ * Speeds, in cells per second, and delays, in seconds.
+ */
 #define EI_PLAYER_MISSILE_SPEED 25
 #define EI_ALIENS_SPEED 10
+#define EI_ALIENS_MAX_SPEED 40
 #define EI_ALIEN_MISSILE_SPEED 10
 #define EI_FIRST_ALIEN_MISSILE_DELAY 2
 #define EI_UFO_SPEED 10
+#define EI_SYNC_INTERVAL 2
 
 #define EI_SCORE_MISSILE 40
 #define EI_SCORE_ALIENS0 30
@@ -43,6 +48,17 @@
 #define EI_SCORE_ALIENS34 10
 #define EI_SCORE_UFO_BASE 100
 
+#define EI_PRIORITY_HIGH (EETG_NR_PRIORITIES - 1)
+
+/*
+ * Order in which entities are processed on a tick.
+ */
+#define EI_TIMER_PRIORITY_SYNC           0
+#define EI_TIMER_PRIORITY_PLAYER_MISSILE 1
+#define EI_TIMER_PRIORITY_ALIENS         2
+#define EI_TIMER_PRIORITY_UFO            3
+#define EI_TIMER_PRIORITY_ALIEN_MISSILE  4
+
 #define EI_TITLE_SPRITE                                                     \
 " _____                                                   _____ \n"         \
 "( ___ )-------------------------------------------------( ___ )\n"         \
@@ -102,6 +118,22 @@
 #define EI_TYPE_UFO             8
 #define EI_TYPE_STATUS          9
 #define EI_TYPE_END_TITLE       10
+#define EI_TYPE_ALIEN_GROUP     11
+
+/*
+ * Return the number of ticks per cell for the given speed.
+ */
+static int
+ei_get_period(int speed)
+{
+    int period;
+
+    assert(speed > 0);
+
+    period = EI_TICK_RATE / speed;
+
+    return (period == 0) ? 1 : period;
+}
 
 static const char *
 ei_get_group_sprite1(size_t group)
@@ -180,22 +212,25 @@ ei_has_type(const struct eetg_object *object1,
 }
 
 static void
-ei_bunker_reset_sprite(struct ei_bunker *bunker)
+ei_bunker_reset(struct ei_bunker *bunker)
 {
     assert(bunker);
 
-    snprintf(bunker->sprite, sizeof(bunker->sprite), "%s", EI_BUNKER_SPRITE);
+    eetg_object_reset_mask(&bunker->object);
 }
 
 static void
-ei_bunker_init(struct ei_bunker *bunker)
+ei_bunker_init(struct ei_bunker *bunker, const struct eetg_sprite *sprite)
 {
     assert(bunker);
 
-    ei_bunker_reset_sprite(bunker);
-
-    eetg_object_init(&bunker->object, EI_TYPE_BUNKER, bunker->sprite);
+    eetg_object_init(&bunker->object, EI_TYPE_BUNKER, sprite);
     eetg_object_set_color(&bunker->object, EETG_COLOR_CYAN);
+    eetg_object_set_static(&bunker->object, true);
+    eetg_object_set_mask(&bunker->object, &bunker->mask);
+    eetg_encoding_init(&bunker->encoding, bunker->encoding_buffer,
+                       sizeof(bunker->encoding_buffer));
+    eetg_object_set_encoding(&bunker->object, &bunker->encoding);
 }
 
 static struct ei_bunker *
@@ -217,27 +252,38 @@ ei_bunker_get_object(struct ei_bunker *bunker)
 static bool
 ei_bunker_damage(struct ei_bunker *bunker, int x, int y)
 {
-    char *sprite;
-    int index;
-
     assert(bunker);
 
-    index = eetg_object_get_cell(&bunker->object, x, y);
+    eetg_object_clear_cell(&bunker->object, x, y);
 
-    sprite = (char *)eetg_object_get_sprite(&bunker->object);
+    return eetg_object_is_empty(&bunker->object);
+}
 
-    sprite[index] = ' ';
+static int
+ei_count_bits(uint64_t bits)
+{
+    return __builtin_popcountll(bits);
+}
 
-    return eetg_object_is_empty(&bunker->object);
+static int
+ei_find_last_bit(uint64_t bits)
+{
+    assert(bits != 0);
+
+    return 63 - __builtin_clzll(bits);
 }
 
 static void
-ei_alien_init(struct ei_alien *alien, const char *sprite, int color)
+ei_alien_init(struct ei_alien *alien, const struct eetg_sprite *sprite,
+              int color, int group, int index)
 {
     assert(alien);
 
     eetg_object_init(&alien->object, EI_TYPE_ALIEN, sprite);
     eetg_object_set_color(&alien->object, color);
+
+    alien->group = group;
+    alien->index = index;
 }
 
 static struct ei_alien *
@@ -256,81 +302,19 @@ ei_alien_get_object(struct ei_alien *alien)
     return &alien->object;
 }
 
-static bool
-ei_alien_is_dead(const struct ei_alien *alien)
-{
-    assert(alien);
-
-    return (eetg_object_get_world(&alien->object) == NULL);
-}
-
-static int
-ei_alien_get_x(const struct ei_alien *alien)
-{
-    assert(alien);
-
-    return eetg_object_get_x(&alien->object);
-}
-
-static int
-ei_alien_get_width(const struct ei_alien *alien)
-{
-    assert(alien);
-
-    return eetg_object_get_width(&alien->object);
-}
-
-static bool
-ei_alien_move_down(struct ei_alien *alien)
+static uint64_t
+ei_alien_group_get_full_mask(void)
 {
-    struct eetg_object *object;
-    bool game_over = false;
-    int y;
-
-    assert(alien);
-
-    object = &alien->object;
-
-    y = eetg_object_get_y(object) + 1;
-
-    eetg_object_move(object, eetg_object_get_x(object), y);
-
-    if (y >= (EETG_ROWS - 1)) {
-        game_over = true;
+    if (EI_ALIEN_GROUP_SIZE == 64) {
+        return UINT64_MAX;
     }
 
-    return game_over;
+    return (UINT64_C(1) << EI_ALIEN_GROUP_SIZE) - 1;
 }
 
 static void
-ei_alien_move_left(struct ei_alien *alien)
-{
-    struct eetg_object *object;
-
-    assert(alien);
-
-    object = &alien->object;
-
-    eetg_object_move(object, eetg_object_get_x(object) - 1,
-                     eetg_object_get_y(object));
-}
-
-static void
-ei_alien_move_right(struct ei_alien *alien)
-{
-    struct eetg_object *object;
-
-    assert(alien);
-
-    object = &alien->object;
-
-    eetg_object_move(object, eetg_object_get_x(object) + 1,
-                     eetg_object_get_y(object));
-}
-
-static void
-ei_alien_group_init(struct ei_alien_group *group, const char *sprite1,
-                    const char *sprite2, int color)
+ei_alien_group_init(struct ei_alien_group *group, int index,
+                    const char *sprite1, const char *sprite2, int color)
 {
     assert(group);
     assert(sprite1);
@@ -338,15 +322,15 @@ ei_alien_group_init(struct ei_alien_group *group, const char *sprite1,
     assert(sprite2);
     assert(strlen(sprite2) == (EI_ALIEN_WIDTH + 1));
 
-    group->sprites[0] = sprite1;
-    group->sprites[1] = sprite2;
+    eetg_object_init_compound(&group->object, EI_TYPE_ALIEN_GROUP);
+    eetg_sprite_init(&group->sprites[0], sprite1);
+    eetg_sprite_init(&group->sprites[1], sprite2);
     group->sprite_index = 0;
-
-    memcpy(group->sprite, group->sprites[group->sprite_index],
-           sizeof(group->sprite));
+    group->alive = 0;
 
     for (size_t i = 0; i < ARRAY_SIZE(group->aliens); i++) {
-        ei_alien_init(&group->aliens[i], group->sprite, color);
+        ei_alien_init(&group->aliens[i], &group->sprites[group->sprite_index],
+                      color, index, i);
     }
 }
 
@@ -358,40 +342,39 @@ ei_alien_group_attach(struct ei_alien_group *group,
 
     assert(group);
 
+    eetg_object_remove_members(&group->object);
+
     for (size_t i = 0; i < ARRAY_SIZE(group->aliens); i++) {
         struct ei_alien *alien = &group->aliens[i];
 
-        eetg_world_add(world, ei_alien_get_object(alien), x, y);
+        eetg_object_add_member(&group->object, ei_alien_get_object(alien),
+                               x, 0);
 
         x += EI_ALIEN_WIDTH;
     }
+
+    eetg_world_add(world, &group->object, 0, y);
+
+    group->alive = ei_alien_group_get_full_mask();
 }
 
-static bool
-ei_alien_group_has_alien(const struct ei_alien_group *group,
-                         const struct ei_alien *alien)
+static void
+ei_alien_group_kill(struct ei_alien_group *group, int index)
 {
-    bool alien_present = false;
-    const struct ei_alien *end;
+    struct eetg_object *object;
 
     assert(group);
+    assert(group->alive & (UINT64_C(1) << index));
 
-    end = &group->aliens[ARRAY_SIZE(group->aliens)];
-
-    if ((alien >= group->aliens) && (alien < end)) {
-        alien_present = true;
-    }
+    group->alive &= ~(UINT64_C(1) << index);
 
-    return alien_present;
-}
+    object = &group->object;
+    eetg_object_remove_member(object,
+                              ei_alien_get_object(&group->aliens[index]));
 
-static struct ei_alien *
-ei_alien_group_get(struct ei_alien_group *group, size_t index)
-{
-    assert(group);
-    assert(index < ARRAY_SIZE(group->aliens));
-
-    return &group->aliens[index];
+    if (group->alive == 0) {
+        eetg_world_remove(eetg_object_get_world(object), object);
+    }
 }
 
 static void
@@ -400,102 +383,92 @@ ei_alien_group_twerk(struct ei_alien_group *group)
     assert(group);
 
     group->sprite_index = (group->sprite_index + 1) & 1;
-    memcpy(group->sprite, group->sprites[group->sprite_index],
-           sizeof(group->sprite));
+
+    for (size_t i = 0; i < ARRAY_SIZE(group->aliens); i++) {
+        eetg_object_set_sprite(ei_alien_get_object(&group->aliens[i]),
+                               &group->sprites[group->sprite_index]);
+    }
 }
 
+/*
+ * The whole group is moved at once, and borders are detected from the
+ * bounding box of its live aliens.
+ */
 static bool
 ei_alien_group_move_down(struct ei_alien_group *group)
 {
-    bool game_over = false;
+    struct eetg_object *object;
+    int y, nr_rows;
 
     ei_alien_group_twerk(group);
 
-    for (size_t i = 0; i < ARRAY_SIZE(group->aliens); i++) {
-        struct ei_alien *alien = &group->aliens[i];
+    if (group->alive == 0) {
+        return false;
+    }
 
-        if (!ei_alien_is_dead(alien)) {
-            bool tmp;
+    object = &group->object;
+    y = eetg_object_get_y(object) + 1;
 
-            tmp = ei_alien_move_down(alien);
+    /*
+     * Moving may kill the last alien of the group, which then leaves
+     * the world.
+     */
+    nr_rows = eetg_world_get_nr_rows(eetg_object_get_world(object));
 
-            if (tmp) {
-                game_over = true;
-            }
-        }
-    }
+    eetg_object_move(object, eetg_object_get_x(object), y);
 
-    return game_over;
+    return ((y + eetg_object_get_height(object) - 1) >= (nr_rows - 1));
 }
 
 static bool
 ei_alien_group_move_left(struct ei_alien_group *group)
 {
-    bool border_reached = false;
+    struct eetg_object *object;
 
     ei_alien_group_twerk(group);
 
-    for (size_t i = 0; i < ARRAY_SIZE(group->aliens); i++) {
-        struct ei_alien *alien = &group->aliens[i];
+    if (group->alive == 0) {
+        return false;
+    }
 
-        if (!ei_alien_is_dead(alien)) {
-            ei_alien_move_left(alien);
+    object = &group->object;
 
-            if (!border_reached && (ei_alien_get_x(alien) == 0)) {
-                border_reached = true;
-            }
-        }
+    eetg_object_move(object, eetg_object_get_x(object) - 1,
+                     eetg_object_get_y(object));
+
+    if (group->alive == 0) {
+        return false;
     }
 
-    return border_reached;
+    return (eetg_object_get_x(object) == 0);
 }
 
 static bool
 ei_alien_group_move_right(struct ei_alien_group *group)
 {
-    bool border_reached = false;
+    struct eetg_object *object;
+    int x, nr_columns;
 
     ei_alien_group_twerk(group);
 
-    for (size_t i = ARRAY_SIZE(group->aliens) - 1;
-         i < ARRAY_SIZE(group->aliens); i--) {
-        struct ei_alien *alien = &group->aliens[i];
-
-        if (!ei_alien_is_dead(alien)) {
-            ei_alien_move_right(alien);
-
-            if (!border_reached) {
-                int x;
-
-                x = ei_alien_get_x(alien) + ei_alien_get_width(alien) - 1;
-
-                if (x == (EETG_COLUMNS - 1)) {
-                    border_reached = true;
-                }
-            }
-        }
+    if (group->alive == 0) {
+        return false;
     }
 
-    return border_reached;
-}
+    object = &group->object;
 
-static struct ei_alien_group *
-ei_game_find_alien_group(struct ei_game *game, struct ei_alien *alien)
-{
-    struct ei_alien_group *group = NULL;
+    eetg_object_move(object, eetg_object_get_x(object) + 1,
+                     eetg_object_get_y(object));
 
-    assert(alien);
+    if (group->alive == 0) {
+        return false;
+    }
 
-    for (size_t i = 0; i < ARRAY_SIZE(game->aliens); i++) {
-        struct ei_alien_group *tmp = &game->aliens[i];
+    x = eetg_object_get_x(object) + eetg_object_get_width(object) - 1;
 
-        if (ei_alien_group_has_alien(tmp, alien)) {
-            group = tmp;
-            break;
-        }
-    }
+    nr_columns = eetg_world_get_nr_columns(eetg_object_get_world(object));
 
-    return group;
+    return (x == (nr_columns - 1));
 }
 
 static void
@@ -508,7 +481,7 @@ ei_game_add_bunkers(struct ei_game *game)
     for (size_t i = 0; i < ARRAY_SIZE(game->bunkers); i++) {
         struct ei_bunker *bunker = &game->bunkers[i];
 
-        ei_bunker_reset_sprite(bunker);
+        ei_bunker_reset(bunker);
         eetg_world_add(&game->world, ei_bunker_get_object(bunker), x, 17);
 
         x += 20;
@@ -526,6 +499,12 @@ ei_game_add_aliens(struct ei_game *game)
         ei_alien_group_attach(group, &game->world,
                               EI_ALIEN_STARTING_ROW + (i * 2));
     }
+
+    for (size_t i = 0; i < ARRAY_SIZE(game->column_groups); i++) {
+        game->column_groups[i] = (1U << (EI_NR_ALIEN_GROUPS - 1) << 1) - 1;
+    }
+
+    game->firing_columns = ei_alien_group_get_full_mask();
 }
 
 static void
@@ -533,17 +512,85 @@ ei_game_update_status(struct ei_game *game)
 {
     assert(game);
 
-    snprintf(game->status_sprite, sizeof(game->status_sprite),
+    snprintf(game->status_text, sizeof(game->status_text),
              EI_STATUS_SPRITE_FORMAT, game->score, game->nr_lives);
+    eetg_sprite_update(&game->status_sprite);
+    eetg_object_invalidate(&game->status);
 }
 
+static struct eetg_object *
+ei_game_get_object(const struct ei_game *game, eetg_handle_t handle)
+{
+    assert(game);
+
+    return eetg_pool_get(&game->pool, handle);
+}
+
+static eetg_handle_t
+ei_game_spawn(struct ei_game *game, int type,
+              const struct eetg_sprite *sprite, int color, int priority)
+{
+    struct eetg_object *object;
+    eetg_handle_t handle;
+
+    assert(game);
+
+    handle = eetg_pool_spawn(&game->pool, type, sprite);
+    object = ei_game_get_object(game, handle);
+    assert(object);
+
+    eetg_object_set_color(object, color);
+    eetg_object_set_priority(object, priority);
+
+    return handle;
+}
+
+/*
+ * Despawn the object referred to by the given handle, if any, and reset
+ * the handle.
+ */
 static void
-ei_game_prepare(struct ei_game *game)
+ei_game_despawn(struct ei_game *game, eetg_handle_t *handle)
+{
+    assert(game);
+    assert(handle);
+
+    if (ei_game_get_object(game, *handle)) {
+        eetg_pool_despawn(&game->pool, *handle);
+    }
+
+    *handle = EETG_HANDLE_NULL;
+}
+
+static void
+ei_game_clear_world(struct ei_game *game)
 {
     assert(game);
 
     eetg_world_clear(&game->world);
 
+    ei_game_despawn(game, &game->player_missile);
+    ei_game_despawn(game, &game->alien_missile);
+    ei_game_despawn(game, &game->ufo);
+
+    for (size_t i = 0; i < ARRAY_SIZE(game->aliens); i++) {
+        game->aliens[i].alive = 0;
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(game->column_groups); i++) {
+        game->column_groups[i] = 0;
+    }
+
+    game->firing_columns = 0;
+}
+
+static void
+ei_game_prepare(struct ei_game *game)
+{
+    assert(game);
+
+    ei_game_clear_world(game);
+
     game->state = EI_STATE_PREPARED;
 }
 
@@ -552,7 +599,7 @@ ei_game_start(struct ei_game *game)
 {
     assert(game);
 
-    eetg_world_clear(&game->world);
+    ei_game_clear_world(game);
 
     eetg_world_add(&game->world, &game->player, 37, 23);
 
@@ -561,15 +608,23 @@ ei_game_start(struct ei_game *game)
 
     eetg_world_add(&game->world, &game->status, 26, 0);
 
-    game->player_missile_counter_reload = EI_FPS / EI_PLAYER_MISSILE_SPEED;
-    game->player_missile_counter = game->player_missile_counter_reload;
-    game->aliens_speed_counter_reload = EI_FPS / EI_ALIENS_SPEED;
-    game->aliens_speed_counter = game->aliens_speed_counter_reload;
-    game->first_alien_missile_counter = EI_FPS * EI_FIRST_ALIEN_MISSILE_DELAY;
-    game->alien_missile_counter_reload = EI_FPS / EI_ALIEN_MISSILE_SPEED;
-    game->ufo_counter_reload = EI_FPS / EI_UFO_SPEED;
+    game->player_missile_period = ei_get_period(EI_PLAYER_MISSILE_SPEED);
+    game->aliens_period = ei_get_period(EI_ALIENS_SPEED);
+    game->alien_missile_period = ei_get_period(EI_ALIEN_MISSILE_SPEED);
+    game->ufo_period = ei_get_period(EI_UFO_SPEED);
     game->nr_dead_aliens = 0;
 
+    eetg_timer_cancel(&game->player_missile_timer);
+    eetg_timer_cancel(&game->ufo_timer);
+    eetg_timer_schedule(&game->timer_wheel, &game->aliens_timer,
+                        game->aliens_period);
+
+    /*
+     * Aliens start firing on the tick following the initial delay.
+     */
+    eetg_timer_schedule(&game->timer_wheel, &game->alien_missile_timer,
+                        (EI_TICK_RATE * EI_FIRST_ALIEN_MISSILE_DELAY) + 1);
+
     game->aliens_move_left = false;
     game->aliens_move_down = false;
 
@@ -579,11 +634,20 @@ ei_game_start(struct ei_game *game)
 static void
 ei_game_kill_alien(struct ei_game *game, struct ei_alien *alien)
 {
-    int group, score;
+    int group, column, score;
 
     assert(alien);
 
-    group = ei_game_find_alien_group(game, alien) - game->aliens;
+    group = alien->group;
+    column = alien->index;
+
+    ei_alien_group_kill(&game->aliens[group], column);
+
+    game->column_groups[column] &= ~(1U << group);
+
+    if (game->column_groups[column] == 0) {
+        game->firing_columns &= ~(UINT64_C(1) << column);
+    }
 
     if (group == 0) {
         score = EI_SCORE_ALIENS0;
@@ -597,24 +661,22 @@ ei_game_kill_alien(struct ei_game *game, struct ei_alien *alien)
 
     ei_game_update_status(game);
 
-    eetg_world_remove(&game->world, ei_alien_get_object(alien));
-
     game->nr_dead_aliens++;
 
-    if (game->nr_dead_aliens == (EI_NR_ALIEN_GROUPS * EI_ALIEN_GROUP_SIZE)) {
+    if (game->firing_columns == 0) {
         ei_game_prepare(game);
     } else {
         int aliens_speed;
 
         aliens_speed = game->nr_dead_aliens / 2;
 
-        if (aliens_speed < (EI_FPS / 5)) {
-            aliens_speed = EI_FPS / 5;
-        } else if (aliens_speed > ((EI_FPS * 4) / 5)) {
-            aliens_speed = ((EI_FPS * 4) / 5);
+        if (aliens_speed < EI_ALIENS_SPEED) {
+            aliens_speed = EI_ALIENS_SPEED;
+        } else if (aliens_speed > EI_ALIENS_MAX_SPEED) {
+            aliens_speed = EI_ALIENS_MAX_SPEED;
         }
 
-        game->aliens_speed_counter_reload = EI_FPS / aliens_speed;
+        game->aliens_period = ei_get_period(aliens_speed);
     }
 }
 
@@ -631,12 +693,25 @@ ei_game_damage_bunker(struct ei_game *game, struct ei_bunker *bunker,
     }
 }
 
+/*
+ * Remove the alien missile, and let the aliens fire again as soon as
+ * possible.
+ */
+static void
+ei_game_remove_alien_missile(struct ei_game *game)
+{
+    assert(game);
+
+    ei_game_despawn(game, &game->alien_missile);
+    eetg_timer_schedule(&game->timer_wheel, &game->alien_missile_timer, 0);
+}
+
 static void
 ei_game_terminate(struct ei_game *game)
 {
     assert(game);
 
-    eetg_world_clear(&game->world);
+    ei_game_clear_world(game);
 
     eetg_world_add(&game->world, &game->end_title, 12, 10);
     eetg_world_add(&game->world, &game->status, 26, 6);
@@ -668,19 +743,23 @@ ei_game_handle_player_missile_collision(struct ei_game *game,
                                         int x, int y)
 {
     assert(game);
+    assert(missile == ei_game_get_object(game, game->player_missile));
+    (void)missile;
 
-    eetg_world_remove(&game->world, missile);
+    ei_game_despawn(game, &game->player_missile);
 
     if (eetg_object_get_type(object) == EI_TYPE_BUNKER) {
         ei_game_damage_bunker(game, ei_bunker_get(object), x, y);
     } else if (eetg_object_get_type(object) == EI_TYPE_ALIEN_MISSILE) {
         game->score += EI_SCORE_MISSILE;
-        eetg_world_remove(&game->world, object);
+        ei_game_remove_alien_missile(game);
     } else if (eetg_object_get_type(object) == EI_TYPE_ALIEN) {
         ei_game_kill_alien(game, ei_alien_get(object));
     } else if (eetg_object_get_type(object) == EI_TYPE_UFO) {
-        game->score += EI_SCORE_UFO_BASE * ((eetg_rand() % 5) + 1);
-        eetg_world_remove(&game->world, object);
+        assert(object == ei_game_get_object(game, game->ufo));
+        game->score += EI_SCORE_UFO_BASE
+                       * ((eetg_world_rand(&game->world) % 5) + 1);
+        ei_game_despawn(game, &game->ufo);
     }
 }
 
@@ -708,7 +787,9 @@ ei_game_handle_alien_missile_collision(struct ei_game *game,
         return;
     }
 
-    eetg_world_remove(&game->world, missile);
+    assert(missile == ei_game_get_object(game, game->alien_missile));
+    (void)missile;
+    ei_game_remove_alien_missile(game);
 
     if (eetg_object_get_type(object) == EI_TYPE_BUNKER) {
         ei_game_damage_bunker(game, ei_bunker_get(object), x, y);
@@ -802,23 +883,29 @@ ei_game_process_game_input(struct ei_game *game, char c)
         x = eetg_object_get_x(player_object);
         width = eetg_object_get_width(player_object);
 
-        if ((x + width) < EETG_COLUMNS) {
+        if ((x + width) < eetg_world_get_nr_columns(&game->world)) {
             eetg_object_move(player_object, x + 1,
                              eetg_object_get_y(player_object));
         }
     } else if (c == ' ') {
-        struct eetg_object *player_missile = &game->player_missile;
-
-        if (eetg_object_get_world(player_missile) == NULL) {
+        if (ei_game_get_object(game, game->player_missile) == NULL) {
             struct eetg_object *player_object = &game->player;
+            struct eetg_object *player_missile;
             int x, y;
 
             x = eetg_object_get_x(player_object);
             y = eetg_object_get_y(player_object);
 
-            eetg_world_add(&game->world, player_missile, x + 2, y - 1);
+            game->player_missile = ei_game_spawn(game, EI_TYPE_PLAYER_MISSILE,
+                                                 &game->player_missile_sprite,
+                                                 EETG_COLOR_WHITE,
+                                                 EI_PRIORITY_HIGH);
+            player_missile = ei_game_get_object(game, game->player_missile);
 
-            game->player_missile_counter = game->player_missile_counter_reload;
+            eetg_timer_schedule(&game->timer_wheel,
+                                &game->player_missile_timer,
+                                game->player_missile_period);
+            eetg_world_add(&game->world, player_missile, x + 2, y - 1);
         }
     }
 
@@ -826,132 +913,136 @@ ei_game_process_game_input(struct ei_game *game, char c)
 }
 
 static void
-ei_game_process_player_missile(struct ei_game *game)
+ei_game_process_player_missile(void *arg)
 {
+    struct ei_game *game = arg;
+    struct eetg_object *missile;
     int x, y;
 
     assert(game);
 
-    if (eetg_object_get_world(&game->player_missile) == NULL) {
-        return;
-    }
-
-    assert(game->player_missile_counter > 0);
-    game->player_missile_counter--;
+    missile = ei_game_get_object(game, game->player_missile);
 
-    if (game->player_missile_counter != 0) {
+    if ((game->state != EI_STATE_PLAYING) || (missile == NULL)) {
         return;
     }
 
-    game->player_missile_counter = game->player_missile_counter_reload;
+    eetg_timer_schedule(&game->timer_wheel, &game->player_missile_timer,
+                        game->player_missile_period);
 
-    x = eetg_object_get_x(&game->player_missile);
-    y = eetg_object_get_y(&game->player_missile) - 1;
+    x = eetg_object_get_x(missile);
+    y = eetg_object_get_y(missile) - 1;
 
     if (y == 0) {
-        eetg_world_remove(&game->world, &game->player_missile);
+        ei_game_despawn(game, &game->player_missile);
     } else {
-        eetg_object_move(&game->player_missile, x, y);
+        eetg_object_move(missile, x, y);
     }
 }
 
+/*
+ * Select the alien firing the next missile.
+ *
+ * A column index is drawn among as many columns as there are columns
+ * with live aliens, and the bottom-most live alien of that column fires,
+ * if any.
+ */
 static struct ei_alien *
 ei_game_select_firing_alien(struct ei_game *game)
 {
-    struct ei_alien *alien = NULL;
-    int nr_firing_aliens = 0;
+    int nr_firing_columns, column;
+    uint32_t groups;
 
     assert(game);
 
-    for (size_t i = 0; i < EI_ALIEN_GROUP_SIZE; i++) {
-        for (size_t j = 0; j < ARRAY_SIZE(game->aliens); j++) {
-            struct ei_alien *tmp = ei_alien_group_get(&game->aliens[j], i);
+    nr_firing_columns = ei_count_bits(game->firing_columns);
 
-            if (!ei_alien_is_dead(tmp)) {
-                nr_firing_aliens++;
-                break;
-            }
-        }
+    if (nr_firing_columns == 0) {
+        return NULL;
     }
 
-    if (nr_firing_aliens > 0) {
-        int index;
-
-        index = eetg_rand() % nr_firing_aliens;
-
-        for (size_t i = ARRAY_SIZE(game->aliens) - 1;
-             i < ARRAY_SIZE(game->aliens); i--) {
-            struct ei_alien *tmp = ei_alien_group_get(&game->aliens[i], index);
+    column = eetg_world_rand(&game->world) % nr_firing_columns;
+    groups = game->column_groups[column];
 
-            if (!ei_alien_is_dead(tmp)) {
-                alien = tmp;
-                break;
-            }
-        }
+    if (groups == 0) {
+        return NULL;
     }
 
-    return alien;
+    return &game->aliens[ei_find_last_bit(groups)].aliens[column];
 }
 
+/*
+ * While there is no alien missile, the aliens attempt to fire on every
+ * tick.
+ */
 static void
-ei_game_process_alien_missile(struct ei_game *game)
+ei_game_process_alien_missile(void *arg)
 {
+    struct ei_game *game = arg;
+    struct eetg_object *missile;
+
     assert(game);
 
-    if (game->first_alien_missile_counter != 0) {
-        assert(game->first_alien_missile_counter > 0);
-        game->first_alien_missile_counter--;
+    if (game->state != EI_STATE_PLAYING) {
         return;
     }
 
-    if (eetg_object_get_world(&game->alien_missile) != NULL) {
-        assert(game->alien_missile_counter > 0);
-        game->alien_missile_counter--;
+    missile = ei_game_get_object(game, game->alien_missile);
 
-        if (game->alien_missile_counter == 0) {
-            int x, y;
-
-            game->alien_missile_counter = game->alien_missile_counter_reload;
+    if (missile) {
+        int x, y;
 
-            x = eetg_object_get_x(&game->alien_missile);
-            y = eetg_object_get_y(&game->alien_missile);
+        x = eetg_object_get_x(missile);
+        y = eetg_object_get_y(missile);
 
-            if (y == EETG_ROWS) {
-                eetg_world_remove(&game->world, &game->alien_missile);
-            } else {
-                eetg_object_move(&game->alien_missile, x, y + 1);
-            }
+        if (y == eetg_world_get_nr_rows(&game->world)) {
+            ei_game_despawn(game, &game->alien_missile);
+        } else {
+            eetg_object_move(missile, x, y + 1);
         }
     } else {
         struct ei_alien *alien;
-        int x, y;
 
         alien = ei_game_select_firing_alien(game);
 
         if (alien) {
+            int x, y;
+
             x = eetg_object_get_x(&alien->object);
             y = eetg_object_get_y(&alien->object);
 
-            eetg_world_add(&game->world, &game->alien_missile, x, y + 1);
-
-            game->alien_missile_counter = game->alien_missile_counter_reload;
+            game->alien_missile = ei_game_spawn(game, EI_TYPE_ALIEN_MISSILE,
+                                                &game->alien_missile_sprite,
+                                                EETG_COLOR_MAGENTA,
+                                                EI_PRIORITY_HIGH);
+            missile = ei_game_get_object(game, game->alien_missile);
+            eetg_world_add(&game->world, missile, x, y + 1);
         }
     }
+
+    if (game->state != EI_STATE_PLAYING) {
+        return;
+    }
+
+    eetg_timer_schedule(&game->timer_wheel, &game->alien_missile_timer,
+                        ei_game_get_object(game, game->alien_missile)
+                        ? game->alien_missile_period
+                        : 1);
 }
 
 static void
-ei_game_process_aliens(struct ei_game *game)
+ei_game_process_aliens(void *arg)
 {
-    assert(game);
-    assert(game->aliens_speed_counter > 0);
+    struct ei_game *game = arg;
 
-    game->aliens_speed_counter--;
+    assert(game);
 
-    if (game->aliens_speed_counter != 0) {
+    if (game->state != EI_STATE_PLAYING) {
         return;
     }
 
-    game->aliens_speed_counter = game->aliens_speed_counter_reload;
+    eetg_timer_schedule(&game->timer_wheel, &game->aliens_timer,
+                        game->aliens_period);
 
     if (game->aliens_move_down) {
         for (size_t i = ARRAY_SIZE(game->aliens) - 1;
@@ -967,27 +1058,37 @@ ei_game_process_aliens(struct ei_game *game)
 
         game->aliens_move_down = false;
 
-        if (eetg_object_get_world(&game->ufo) == NULL) {
+        if (ei_game_get_object(game, game->ufo) == NULL) {
             int n;
 
-            n = eetg_rand() % 3;
+            n = eetg_world_rand(&game->world) % 3;
 
             if (n == 0) {
+                struct eetg_object *ufo;
                 int x;
 
-                n = eetg_rand() % 2;
+                game->ufo = ei_game_spawn(game, EI_TYPE_UFO, &game->ufo_sprite,
+                                          EETG_COLOR_MAGENTA,
+                                          EI_PRIORITY_HIGH);
+                ufo = ei_game_get_object(game, game->ufo);
+
+                n = eetg_world_rand(&game->world) % 2;
 
                 if (n == 0) {
-                    x = EETG_COLUMNS;
+                    x = eetg_world_get_nr_columns(&game->world);
                     game->ufo_moves_left = true;
                 } else {
-                    x = -eetg_object_get_width(&game->ufo);
+                    x = -eetg_object_get_width(ufo);
                     game->ufo_moves_left = false;
                 }
 
-                eetg_world_add(&game->world, &game->ufo, x, 2);
-
-                game->ufo_counter = game->ufo_counter_reload;
+                /*
+                 * The tick on which the UFO appears counts as the first
+                 * of its period.
+                 */
+                eetg_timer_schedule(&game->timer_wheel, &game->ufo_timer,
+                                    game->ufo_period - 1);
+                eetg_world_add(&game->world, ufo, x, 2);
             }
         }
     } else {
@@ -1016,27 +1117,21 @@ ei_game_process_aliens(struct ei_game *game)
 }
 
 static void
-ei_game_process_ufo(struct ei_game *game)
+ei_game_process_ufo(void *arg)
 {
+    struct ei_game *game = arg;
     struct eetg_object *ufo;
 
     assert(game);
 
-    ufo = &game->ufo;
-
-    if (eetg_object_get_world(ufo) == NULL) {
-        return;
-    }
-
-    assert(game->ufo_counter > 0);
-
-    game->ufo_counter--;
+    ufo = ei_game_get_object(game, game->ufo);
 
-    if (game->ufo_counter != 0) {
+    if ((game->state != EI_STATE_PLAYING) || (ufo == NULL)) {
         return;
     }
 
-    game->ufo_counter = game->ufo_counter_reload;
+    eetg_timer_schedule(&game->timer_wheel, &game->ufo_timer,
+                        game->ufo_period);
 
     if (game->ufo_moves_left) {
         int x;
@@ -1044,7 +1139,7 @@ ei_game_process_ufo(struct ei_game *game)
         x = eetg_object_get_x(ufo) - 1;
 
         if ((x + eetg_object_get_width(ufo)) <= 0) {
-            eetg_world_remove(&game->world, ufo);
+            ei_game_despawn(game, &game->ufo);
         } else {
             eetg_object_move(ufo, x, eetg_object_get_y(ufo));
         }
@@ -1053,8 +1148,8 @@ ei_game_process_ufo(struct ei_game *game)
 
         x = eetg_object_get_x(ufo) + 1;
 
-        if (x >= EETG_COLUMNS) {
-            eetg_world_remove(&game->world, ufo);
+        if (x >= eetg_world_get_nr_columns(&game->world)) {
+            ei_game_despawn(game, &game->ufo);
         } else {
             eetg_object_move(ufo, x, eetg_object_get_y(ufo));
         }
@@ -1066,8 +1161,10 @@ ei_game_init_bunkers(struct ei_game *game)
 {
     assert(game);
 
+    eetg_sprite_init(&game->bunker_sprite, EI_BUNKER_SPRITE);
+
     for (size_t i = 0; i < ARRAY_SIZE(game->bunkers); i++) {
-        ei_bunker_init(&game->bunkers[i]);
+        ei_bunker_init(&game->bunkers[i], &game->bunker_sprite);
     }
 }
 
@@ -1085,8 +1182,55 @@ ei_game_init_aliens(struct ei_game *game)
         sprite2 = ei_get_group_sprite2(i);
         color = ei_get_group_color(i);
 
-        ei_alien_group_init(group, sprite1, sprite2, color);
+        ei_alien_group_init(group, i, sprite1, sprite2, color);
     }
+
+    for (size_t i = 0; i < ARRAY_SIZE(game->column_groups); i++) {
+        game->column_groups[i] = 0;
+    }
+
+    game->firing_columns = 0;
+}
+
+static void
+ei_game_process_sync(void *arg)
+{
+    struct ei_game *game = arg;
+
+    assert(game);
+
+    game->sync_pending = true;
+    eetg_timer_schedule(&game->timer_wheel, &game->sync_timer,
+                        game->sync_period);
+}
+
+static void
+ei_game_init_timers(struct ei_game *game)
+{
+    assert(game);
+
+    eetg_timer_wheel_init(&game->timer_wheel);
+    eetg_timer_init(&game->sync_timer, ei_game_process_sync, game,
+                    EI_TIMER_PRIORITY_SYNC);
+    eetg_timer_init(&game->player_missile_timer,
+                    ei_game_process_player_missile, game,
+                    EI_TIMER_PRIORITY_PLAYER_MISSILE);
+    eetg_timer_init(&game->aliens_timer, ei_game_process_aliens, game,
+                    EI_TIMER_PRIORITY_ALIENS);
+    eetg_timer_init(&game->ufo_timer, ei_game_process_ufo, game,
+                    EI_TIMER_PRIORITY_UFO);
+    eetg_timer_init(&game->alien_missile_timer,
+                    ei_game_process_alien_missile, game,
+                    EI_TIMER_PRIORITY_ALIEN_MISSILE);
+
+    /*
+     * The first frame is a sync. The sync timer marks the next frame to
+     * be rendered.
+     */
+    game->sync_period = EI_TICK_RATE * EI_SYNC_INTERVAL;
+    game->sync_pending = true;
+    eetg_timer_schedule(&game->timer_wheel, &game->sync_timer,
+                        game->sync_period);
 }
 
 void
@@ -1094,73 +1238,253 @@ ei_game_init(struct ei_game *game, eetg_write_fn write_fn, void *arg)
 {
     assert(game);
 
-    game->sync_counter_reload = EI_FPS * 2;
-    game->sync_counter = 1;
+    ei_game_init_timers(game);
 
     game->state = EI_STATE_INTRO;
 
-    ei_game_reset_history(game);
-
     eetg_world_init(&game->world, write_fn, arg);
     eetg_world_register_collision_fn(&game->world,
                                      ei_game_handle_collision,
                                      game);
 
-    eetg_object_init(&game->title, EI_TYPE_TITLE, EI_TITLE_SPRITE);
+    eetg_sprite_init(&game->title_sprite, EI_TITLE_SPRITE);
+    eetg_object_init(&game->title, EI_TYPE_TITLE, &game->title_sprite);
     eetg_object_set_color(&game->title, EETG_COLOR_BLUE);
+    eetg_object_set_static(&game->title, true);
+    eetg_encoding_init(&game->title_encoding, game->title_encoding_buffer,
+                       sizeof(game->title_encoding_buffer));
+    eetg_object_set_encoding(&game->title, &game->title_encoding);
 
-    eetg_object_init(&game->help, EI_TYPE_HELP, EI_HELP_SPRITE);
+    eetg_sprite_init(&game->help_sprite, EI_HELP_SPRITE);
+    eetg_object_init(&game->help, EI_TYPE_HELP, &game->help_sprite);
     eetg_object_set_color(&game->help, EETG_COLOR_RED);
+    eetg_object_set_static(&game->help, true);
 
-    eetg_object_init(&game->start, EI_TYPE_START, EI_START_SPRITE);
+    eetg_sprite_init(&game->start_sprite, EI_START_SPRITE);
+    eetg_object_init(&game->start, EI_TYPE_START, &game->start_sprite);
     eetg_object_set_color(&game->start, EETG_COLOR_RED);
+    eetg_object_set_static(&game->start, true);
 
-    eetg_object_init(&game->player, EI_TYPE_PLAYER, EI_PLAYER_SPRITE);
+    eetg_sprite_init(&game->player_sprite, EI_PLAYER_SPRITE);
+    eetg_object_init(&game->player, EI_TYPE_PLAYER, &game->player_sprite);
     eetg_object_set_color(&game->player, EETG_COLOR_YELLOW);
+    eetg_object_set_priority(&game->player, EI_PRIORITY_HIGH);
 
-    eetg_object_init(&game->player_missile, EI_TYPE_PLAYER_MISSILE, "!\n");
-    eetg_object_set_color(&game->player_missile, EETG_COLOR_WHITE);
+    eetg_sprite_init(&game->player_missile_sprite, "!\n");
 
     ei_game_init_bunkers(game);
     ei_game_init_aliens(game);
 
-    eetg_object_init(&game->alien_missile, EI_TYPE_ALIEN_MISSILE, ":\n");
-    eetg_object_set_color(&game->alien_missile, EETG_COLOR_MAGENTA);
-
-    eetg_object_init(&game->ufo, EI_TYPE_UFO, "<o~o>\n");
-    eetg_object_set_color(&game->ufo, EETG_COLOR_MAGENTA);
-
-    eetg_object_init(&game->status, EI_TYPE_STATUS, game->status_sprite);
+    eetg_sprite_init(&game->alien_missile_sprite, ":\n");
+    eetg_sprite_init(&game->ufo_sprite, "<o~o>\n");
+
+    eetg_pool_init(&game->pool, game->pool_slots,
+                   ARRAY_SIZE(game->pool_slots));
+    game->player_missile = EETG_HANDLE_NULL;
+    game->alien_missile = EETG_HANDLE_NULL;
+    game->ufo = EETG_HANDLE_NULL;
+
+    /*
+     * The status text must be formatted before the sprite is initialized,
+     * so that its size is known. The actual content is set when resetting
+     * the history.
+     */
+    snprintf(game->status_text, sizeof(game->status_text),
+             EI_STATUS_SPRITE_FORMAT, 0, 0);
+    eetg_sprite_init(&game->status_sprite, game->status_text);
+    eetg_object_init(&game->status, EI_TYPE_STATUS, &game->status_sprite);
     eetg_object_set_color(&game->status, EETG_COLOR_RED);
+    eetg_object_set_static(&game->status, true);
+    eetg_object_set_priority(&game->status, EI_PRIORITY_HIGH);
 
-    eetg_object_init(&game->end_title, EI_TYPE_END_TITLE, EI_END_TITLE_SPRITE);
+    eetg_sprite_init(&game->end_title_sprite, EI_END_TITLE_SPRITE);
+    eetg_object_init(&game->end_title, EI_TYPE_END_TITLE,
+                     &game->end_title_sprite);
     eetg_object_set_color(&game->end_title, EETG_COLOR_WHITE);
+    eetg_object_set_static(&game->end_title, true);
+    eetg_encoding_init(&game->end_title_encoding,
+                       game->end_title_encoding_buffer,
+                       sizeof(game->end_title_encoding_buffer));
+    eetg_object_set_encoding(&game->end_title, &game->end_title_encoding);
+
+    ei_game_reset_history(game);
 
     eetg_world_add(&game->world, &game->title, 8, 1);
     eetg_world_add(&game->world, &game->help, 30, 16);
     eetg_world_add(&game->world, &game->start, 30, 20);
 }
 
+void
+ei_game_render(struct ei_game *game)
+{
+    assert(game);
+
+    eetg_world_render(&game->world, game->sync_pending);
+    game->sync_pending = false;
+}
+
+static void
+ei_game_relocate(struct ei_game *game, const struct eetg_reloc *reloc)
+{
+    struct eetg_timer *timers[] = {
+        &game->sync_timer,
+        &game->player_missile_timer,
+        &game->aliens_timer,
+        &game->ufo_timer,
+        &game->alien_missile_timer,
+    };
+
+    struct eetg_object *objects[] = {
+        &game->title,
+        &game->help,
+        &game->start,
+        &game->player,
+        &game->status,
+        &game->end_title,
+    };
+
+    struct eetg_sprite *sprites[] = {
+        &game->title_sprite,
+        &game->help_sprite,
+        &game->start_sprite,
+        &game->player_sprite,
+        &game->player_missile_sprite,
+        &game->bunker_sprite,
+        &game->alien_missile_sprite,
+        &game->ufo_sprite,
+        &game->status_sprite,
+        &game->end_title_sprite,
+    };
+
+    assert(game);
+
+    eetg_world_relocate(&game->world, reloc);
+    eetg_timer_wheel_relocate(&game->timer_wheel, reloc);
+    eetg_pool_relocate(&game->pool, reloc);
+
+    for (size_t i = 0; i < ARRAY_SIZE(timers); i++) {
+        eetg_timer_relocate(timers[i], reloc);
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(objects); i++) {
+        eetg_object_relocate(objects[i], reloc);
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(sprites); i++) {
+        eetg_sprite_relocate(sprites[i], reloc);
+    }
+
+    eetg_encoding_relocate(&game->title_encoding, reloc);
+    eetg_encoding_relocate(&game->end_title_encoding, reloc);
+
+    for (size_t i = 0; i < ARRAY_SIZE(game->bunkers); i++) {
+        eetg_object_relocate(&game->bunkers[i].object, reloc);
+        eetg_encoding_relocate(&game->bunkers[i].encoding, reloc);
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(game->aliens); i++) {
+        struct ei_alien_group *group = &game->aliens[i];
+
+        eetg_object_relocate(&group->object, reloc);
+
+        for (size_t j = 0; j < ARRAY_SIZE(group->aliens); j++) {
+            eetg_object_relocate(&group->aliens[j].object, reloc);
+        }
+
+        for (size_t j = 0; j < ARRAY_SIZE(group->sprites); j++) {
+            eetg_sprite_relocate(&group->sprites[j], reloc);
+        }
+    }
+}
+
+void
+ei_game_snapshot(const struct ei_game *game, struct ei_snapshot *snapshot)
+{
+    assert(game);
+    assert(snapshot);
+    assert(offsetof(struct ei_game, world) == 0);
+
+    /*
+     * The views and outputs of the world aren't part of the simulation
+     * state, and are left out, as they are on restore.
+     */
+    snapshot->base = (uintptr_t)game;
+    memcpy((char *)&snapshot->game + sizeof(game->world),
+           (const char *)game + sizeof(game->world),
+           sizeof(*game) - sizeof(game->world));
+    eetg_world_save(&game->world, &snapshot->game.world);
+}
+
+void
+ei_game_restore(struct ei_game *game, const struct ei_snapshot *snapshot)
+{
+    struct eetg_reloc reloc;
+
+    assert(game);
+    assert(snapshot);
+    assert(offsetof(struct ei_game, world) == 0);
+
+    /*
+     * The world is copied apart, without its views, which are composited
+     * again, and its outputs, which remain those of the game restored
+     * into.
+     */
+    memcpy((char *)game + sizeof(game->world),
+           (const char *)&snapshot->game + sizeof(game->world),
+           sizeof(*game) - sizeof(game->world));
+    eetg_world_restore(&game->world, &snapshot->game.world);
+
+    eetg_reloc_init(&reloc, snapshot->base, sizeof(*game), game);
+    ei_game_relocate(game, &reloc);
+
+    game->sync_pending = true;
+}
+
+uint32_t
+ei_game_hash(const struct ei_game *game)
+{
+    uint32_t hash;
+
+    assert(game);
+
+    hash = eetg_world_hash(&game->world, EETG_HASH_INIT);
+    hash = eetg_hash(hash, &game->timer_wheel.tick,
+                     sizeof(game->timer_wheel.tick));
+    hash = eetg_hash(hash, &game->firing_columns,
+                     sizeof(game->firing_columns));
+    hash = eetg_hash(hash, &game->score, sizeof(game->score));
+    hash = eetg_hash(hash, &game->nr_dead_aliens,
+                     sizeof(game->nr_dead_aliens));
+    hash = eetg_hash(hash, &game->nr_lives, sizeof(game->nr_lives));
+    hash = eetg_hash(hash, &game->state, sizeof(game->state));
+
+    return hash;
+}
+
 bool
-ei_game_process(struct ei_game *game, int8_t c)
+ei_game_process_inputs(struct ei_game *game, const int8_t *inputs,
+                       size_t nr_inputs)
 {
-    bool sync = false;
     bool leave = false;
+    int state;
 
-    game->sync_counter--;
+    assert(game);
+    assert(inputs || (nr_inputs == 0));
 
-    if (game->sync_counter == 0) {
-        sync = true;
-        game->sync_counter = game->sync_counter_reload;
-    }
+    /*
+     * Input is processed according to the state at the start of the tick.
+     */
+    state = game->state;
 
-    eetg_world_render(&game->world, sync);
+    eetg_timer_wheel_run(&game->timer_wheel);
 
-    switch (game->state) {
+    switch (state) {
     case EI_STATE_INTRO:
     case EI_STATE_GAME_OVER:
-        if (c >= 0) {
-            leave = ei_game_process_intro_input(game, (char)c);
+        for (size_t i = 0; i < nr_inputs; i++) {
+            if (inputs[i] >= 0) {
+                leave |= ei_game_process_intro_input(game, (char)inputs[i]);
+            }
         }
 
         break;
@@ -1168,13 +1492,10 @@ ei_game_process(struct ei_game *game, int8_t c)
         ei_game_start(game);
         break;
     case EI_STATE_PLAYING:
-        ei_game_process_player_missile(game);
-        ei_game_process_aliens(game);
-        ei_game_process_ufo(game);
-        ei_game_process_alien_missile(game);
-
-        if (c >= 0) {
-            leave = ei_game_process_game_input(game, (char)c);
+        for (size_t i = 0; i < nr_inputs; i++) {
+            if (inputs[i] >= 0) {
+                leave |= ei_game_process_game_input(game, (char)inputs[i]);
+            }
         }
 
         break;
@@ -1182,3 +1503,9 @@ ei_game_process(struct ei_game *game, int8_t c)
 
     return leave;
 }
+
+bool
+ei_game_process(struct ei_game *game, int8_t c)
+{
+    return ei_game_process_inputs(game, &c, 1);
+}
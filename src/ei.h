@@ -20,16 +20,52 @@
 #define EI_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "eetg.h"
 
-#define EI_FPS 50
+/*
+ * Simulation rate, in ticks per second.
+ *
+ * Speeds are expressed in cells per second, so that the simulation rate
+ * doesn't change the pace of the game, only the granularity of time.
+ * Rendering is performed at an independent rate.
+ */
+#ifndef EI_TICK_RATE
+#define EI_TICK_RATE 50
+#endif
 
 #define EI_NR_ALIEN_GROUPS 5
 #define EI_ALIEN_GROUP_SIZE 10
 #define EI_ALIEN_WIDTH 3
 
+/*
+ * Live aliens are tracked with one bit per alien in each group, and one
+ * bit per group in each column.
+ */
+#if EI_ALIEN_GROUP_SIZE > 64
+#error "alien groups are limited to 64 aliens"
+#endif
+
+#if EI_NR_ALIEN_GROUPS > 32
+#error "the number of alien groups is limited to 32"
+#endif
+
+/*
+ * Transient objects, i.e. missiles and the UFO, are spawned from a pool
+ * when they appear, and despawned when they disappear.
+ */
+#define EI_POOL_SIZE 8
+
+/*
+ * Sizes of the buffers of the encodings of the largest objects, which
+ * are repainted from their encodings.
+ */
+#define EI_TITLE_ENCODING_SIZE      1024
+#define EI_BUNKER_ENCODING_SIZE     128
+#define EI_END_TITLE_ENCODING_SIZE  384
+
 #define EI_STATE_INTRO      0
 #define EI_STATE_PREPARED   1
 #define EI_STATE_PLAYING    2
@@ -37,55 +73,137 @@
 
 struct ei_bunker {
     struct eetg_object object;
-    char sprite[33];
+    struct eetg_mask mask;
+    struct eetg_encoding encoding;
+    char encoding_buffer[EI_BUNKER_ENCODING_SIZE];
 };
 
 struct ei_alien {
     struct eetg_object object;
+    int8_t group;
+    int8_t index;
 };
 
 struct ei_alien_group {
+    struct eetg_object object;
     struct ei_alien aliens[EI_ALIEN_GROUP_SIZE];
-    const char *sprites[2];
-    char sprite[EI_ALIEN_WIDTH + 2];
+    struct eetg_sprite sprites[2];
+    uint64_t alive;
     int8_t sprite_index;
 };
 
 struct ei_game {
     struct eetg_world world;
+    struct eetg_timer_wheel timer_wheel;
+    struct eetg_timer sync_timer;
+    struct eetg_timer player_missile_timer;
+    struct eetg_timer aliens_timer;
+    struct eetg_timer ufo_timer;
+    struct eetg_timer alien_missile_timer;
     struct eetg_object title;
     struct eetg_object help;
     struct eetg_object start;
     struct eetg_object player;
-    struct eetg_object player_missile;
     struct ei_bunker bunkers[4];
     struct ei_alien_group aliens[EI_NR_ALIEN_GROUPS];
-    struct eetg_object alien_missile;
-    struct eetg_object ufo;
     struct eetg_object status;
     struct eetg_object end_title;
+    struct eetg_pool pool;
+    struct eetg_pool_slot pool_slots[EI_POOL_SIZE];
+    eetg_handle_t player_missile;
+    eetg_handle_t alien_missile;
+    eetg_handle_t ufo;
+    struct eetg_encoding title_encoding;
+    struct eetg_encoding end_title_encoding;
+    char title_encoding_buffer[EI_TITLE_ENCODING_SIZE];
+    char end_title_encoding_buffer[EI_END_TITLE_ENCODING_SIZE];
+    struct eetg_sprite title_sprite;
+    struct eetg_sprite help_sprite;
+    struct eetg_sprite start_sprite;
+    struct eetg_sprite player_sprite;
+    struct eetg_sprite player_missile_sprite;
+    struct eetg_sprite bunker_sprite;
+    struct eetg_sprite alien_missile_sprite;
+    struct eetg_sprite ufo_sprite;
+    struct eetg_sprite status_sprite;
+    struct eetg_sprite end_title_sprite;
+    uint32_t column_groups[EI_ALIEN_GROUP_SIZE];
+    uint64_t firing_columns;
     int score;
-    int8_t sync_counter_reload;
-    int8_t sync_counter;
+    int nr_dead_aliens;
+    int sync_period;
+    int player_missile_period;
+    int aliens_period;
+    int alien_missile_period;
+    int ufo_period;
     int8_t nr_lives;
-    int8_t player_missile_counter_reload;
-    int8_t player_missile_counter;
-    int8_t aliens_speed_counter_reload;
-    int8_t aliens_speed_counter;
-    int8_t first_alien_missile_counter;
-    int8_t alien_missile_counter_reload;
-    int8_t alien_missile_counter;
-    int8_t ufo_counter_reload;
-    int8_t ufo_counter;
-    int8_t nr_dead_aliens;
     int8_t state;
+    bool sync_pending;
     bool aliens_move_left;
     bool aliens_move_down;
     bool ufo_moves_left;
-    char status_sprite[32];
+    char status_text[32];
+};
+
+/*
+ * Game snapshot.
+ *
+ * A snapshot is a plain copy of the state of a game, without the views
+ * and outputs of its world, along with the address of that game, from
+ * which its internal pointers are relocated on restore. It
+ * may therefore be copied, stored, and restored into any game, as long
+ * as the constant data it refers to, i.e. functions and sprite texts,
+ * remain at the same addresses.
+ */
+struct ei_snapshot {
+    uintptr_t base;
+    struct ei_game game;
 };
 
 void ei_game_init(struct ei_game *game, eetg_write_fn write_fn, void *arg);
+
+void ei_game_snapshot(const struct ei_game *game,
+                      struct ei_snapshot *snapshot);
+
+/*
+ * Restore a game from a snapshot.
+ *
+ * The game must have been initialized, and keeps its write function.
+ * Since the terminal may not match the snapshot, the next frame is
+ * redrawn from scratch.
+ */
+void ei_game_restore(struct ei_game *game,
+                     const struct ei_snapshot *snapshot);
+
+/*
+ * Render a frame.
+ *
+ * Frames may be rendered at any rate, up to the simulation rate.
+ */
+void ei_game_render(struct ei_game *game);
+
+/*
+ * Run a simulation tick, with the given input character, or -1 if none.
+ *
+ * Return true if the player chose to leave.
+ */
 bool ei_game_process(struct ei_game *game, int8_t c);
 
+/*
+ * Run a simulation tick, with the given inputs, in order, e.g. one per
+ * player sharing the cannon. Inputs of -1 are ignored.
+ *
+ * Return true if a player chose to leave.
+ */
+bool ei_game_process_inputs(struct ei_game *game, const int8_t *inputs,
+                            size_t nr_inputs);
+
+/*
+ * Return a hash of the state of a game.
+ *
+ * Games processing the same inputs from the same seed have the same
+ * hash, which is how peers in lockstep detect that they diverged.
+ */
+uint32_t ei_game_hash(const struct ei_game *game);
+
 #endif /* EI_H */
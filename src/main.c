@@ -16,26 +16,127 @@
 #include <assert.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 #include <termios.h>
 #include <time.h>
 #include <unistd.h>
 
+#include "bot.h"
+#include "cast.h"
 #include "eetg.h"
 #include "ei.h"
+#include "macros.h"
+#include "peer.h"
+#include "rec.h"
+#include "uart.h"
+#include "vt.h"
+#include "wire.h"
+
+/*
+ * Minimum depth of the default FIFO, well above the cost of updating a
+ * cell, cursor move and color change included.
+ */
+#define UART_MIN_FIFO_SIZE 64
+
+/*
+ * Room needed in the FIFO to render a frame in back-pressure mode, i.e.
+ * the cost of the first cell update of a frame, which the engine emits
+ * whatever the budget, with the sequences opening and closing frames.
+ */
+#define UART_MIN_FRAME_ROOM 48
+
+/*
+ * Synthetic boards, scaled up from the default size of worlds, within
+ * the size limits of viewports.
+ */
+#define BENCH_NR_SCALES         4
+#define BENCH_MAX_ALIENS        1024
+#define BENCH_MAX_MISSILES      48
+#define BENCH_ALIEN_SPACING_X   5
+#define BENCH_ALIEN_SPACING_Y   2
+#define BENCH_MISSILE_SPACING   8
+
+/*
+ * The viewport of boards larger than it moves by a fraction of its size
+ * when what it follows gets that close to one of its edges.
+ */
+#define BENCH_PAN_DIVISOR       4
+
+#define BENCH_TYPE_FORMATION    0
+#define BENCH_TYPE_ALIEN        1
+#define BENCH_TYPE_MISSILE      2
 
 static struct termios orig_ios;
 
 static struct ei_game game;
 
+static struct uart uart;
+static bool uart_enabled;
+static int uart_mode = UART_MODE_BLOCKING;
+static size_t uart_frame_room;
+
+static struct bot bot;
+static uint64_t bot_elapsed;
+
+static bool session_enabled;
+
+static struct vt vt;
+static bool vt_enabled;
+
+static struct cast cast;
+static bool cast_enabled;
+static int cast_fd = -1;
+
+static struct peer peer;
+static bool peer_enabled;
+
+static struct rec rec;
+static FILE *rec_file;
+static uint64_t rec_start_time;
+
+static struct rec_player rec_player;
+
+static struct wire_encoder wire;
+static bool wire_enabled;
+static struct wire_screen wire_prev_screen;
+
+static struct ei_game loopback_games[PEER_NR_PLAYERS];
+static struct peer loopback_peers[PEER_NR_PLAYERS];
+
+static struct eetg_world bench_world;
+static struct eetg_sprite bench_alien_sprite;
+static struct eetg_sprite bench_missile_sprite;
+static struct eetg_object bench_formation;
+static struct eetg_object bench_aliens[BENCH_MAX_ALIENS];
+static struct eetg_object bench_missiles[BENCH_MAX_MISSILES];
+static bool bench_missile_hits[BENCH_MAX_MISSILES];
+static unsigned long bench_nr_collisions;
+
 static void
 restore_termios(void)
 {
     tcsetattr(STDIN_FILENO, TCSANOW, &orig_ios);
-    write(STDOUT_FILENO, "\ec", 2);
+
+    /*
+     * Leaving the alternate screen restores the main screen, which must
+     * not be reset. The client resets the terminal at the end of the
+     * compact stream.
+     */
+    if (session_enabled) {
+        eetg_world_end_session(&game.world);
+    } else if (!wire_enabled) {
+        write(STDOUT_FILENO, "\ec", 2);
+    }
 }
 
 static void
@@ -64,22 +165,1304 @@ write_terminal(const void *buffer, size_t size, void *arg)
     write(STDOUT_FILENO, buffer, size);
 }
 
+static void
+writev_terminal(const struct eetg_buffer *buffers, size_t nr_buffers,
+                void *arg)
+{
+    struct iovec iov[EETG_MAX_BUFFERS];
+
+    (void)arg;
+
+    assert(nr_buffers <= ARRAY_SIZE(iov));
+
+    for (size_t i = 0; i < nr_buffers; i++) {
+        iov[i].iov_base = (void *)buffers[i].data;
+        iov[i].iov_len = buffers[i].size;
+    }
+
+    writev(STDOUT_FILENO, iov, nr_buffers);
+}
+
+static void
+report_uart_stats(void)
+{
+    struct uart_stats stats;
+
+    uart_get_stats(&uart, &stats);
+
+    if ((stats.nr_frames == 0) || (stats.elapsed == 0)) {
+        return;
+    }
+
+    fprintf(stderr, "frames: %lu, missed deadlines: %lu, "
+                    "effective fps: %.1f\n",
+            stats.nr_frames, stats.nr_missed_deadlines,
+            (stats.nr_frames * 1000000.0) / stats.elapsed);
+    fprintf(stderr, "bytes: %llu, overruns: %lu\n",
+            (unsigned long long)stats.nr_bytes, stats.nr_overruns);
+    fprintf(stderr, "transmit time per frame: %llu us avg, %llu us max\n",
+            (unsigned long long)(stats.tx_time / stats.nr_frames),
+            (unsigned long long)stats.max_frame_tx_time);
+}
+
+static void
+report_bot_stats(void)
+{
+    struct bot_stats stats;
+
+    bot_get_stats(&bot, &stats);
+
+    if ((stats.nr_ticks == 0) || (bot_elapsed == 0)) {
+        return;
+    }
+
+    fprintf(stderr, "rollouts: %llu, rollouts/s: %.0f, "
+                    "decision time: %llu us avg\n",
+            (unsigned long long)stats.nr_rollouts,
+            (stats.nr_rollouts * 1000000.0) / bot_elapsed,
+            (unsigned long long)(bot_elapsed / stats.nr_ticks));
+}
+
+static void
+stop_bot(void)
+{
+    bot_destroy(&bot);
+}
+
+static void
+report_vt_stats(void)
+{
+    struct vt_stats stats;
+
+    vt_get_stats(&vt, &stats);
+
+    fprintf(stderr, "checked frames: %lu, mismatching frames: %lu\n",
+            stats.nr_frames, stats.nr_mismatches);
+
+    for (int i = 0; i < VT_NR_CLASSES; i++) {
+        fprintf(stderr, "%s bytes: %llu\n", vt_get_class_name(i),
+                (unsigned long long)stats.nr_bytes[i]);
+    }
+}
+
+static void
+report_cast_stats(void)
+{
+    struct cast_stats stats;
+
+    cast_get_stats(&cast, &stats);
+
+    fprintf(stderr, "broadcast frames: %lu, keyframes: %lu, resyncs: %lu\n",
+            stats.nr_frames, stats.nr_keyframes, stats.nr_resyncs);
+    fprintf(stderr, "broadcast bytes encoded: %llu, sent: %llu\n",
+            (unsigned long long)stats.nr_encoded_bytes,
+            (unsigned long long)stats.nr_sent_bytes);
+}
+
+static void
+report_peer_stats(void)
+{
+    struct peer_stats stats;
+    uint32_t tick;
+
+    peer_get_stats(&peer, &stats);
+
+    fprintf(stderr, "lockstep ticks: %llu, stalls: %lu, hash checks: %lu\n",
+            (unsigned long long)stats.nr_ticks, stats.nr_stalls,
+            stats.nr_checks);
+    fprintf(stderr, "lockstep bytes sent: %llu, received: %llu\n",
+            (unsigned long long)stats.nr_sent_bytes,
+            (unsigned long long)stats.nr_received_bytes);
+
+    if (peer_is_desynced(&peer, &tick)) {
+        fprintf(stderr, "lockstep desync at tick %lu\n", (unsigned long)tick);
+    }
+}
+
+static void
+report_wire_stats(const struct wire_stats *stats)
+{
+    if (stats->nr_frames == 0) {
+        return;
+    }
+
+    fprintf(stderr, "compact frames: %lu\n", stats->nr_frames);
+    fprintf(stderr, "compact bytes: %llu, %.1f per frame\n",
+            (unsigned long long)stats->nr_bytes,
+            (double)stats->nr_bytes / stats->nr_frames);
+}
+
+static void
+report_wire_encoder_stats(void)
+{
+    struct wire_stats stats;
+
+    wire_encoder_get_stats(&wire, &stats);
+    report_wire_stats(&stats);
+}
+
+/*
+ * Return the time of the monotonic clock, in microseconds.
+ */
+static uint64_t
+get_time(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+static void
+close_recording(void)
+{
+    struct rec_stats stats;
+
+    if (!rec_close(&rec)) {
+        fprintf(stderr, "recording: write error\n");
+    }
+
+    fclose(rec_file);
+
+    rec_get_stats(&rec, &stats);
+
+    fprintf(stderr, "recorded frames: %lu, keyframes: %lu\n",
+            stats.nr_frames, stats.nr_keyframes);
+    fprintf(stderr, "recorded bytes: %llu, file bytes: %llu\n",
+            (unsigned long long)stats.nr_raw_bytes,
+            (unsigned long long)stats.nr_file_bytes);
+}
+
+/*
+ * Play a recording in real time, starting at the given time.
+ */
+static bool
+play_recording(const char *path, uint32_t start)
+{
+    struct rec_frame frame;
+    uint64_t origin;
+    FILE *file;
+    bool valid;
+
+    file = fopen(path, "rb");
+
+    if (!file) {
+        perror(path);
+        return false;
+    }
+
+    valid = rec_player_init(&rec_player, file)
+            && rec_player_seek(&rec_player, start);
+
+    /*
+     * The frames before the start time are written at once.
+     */
+    origin = (get_time() / 1000) - start;
+
+    while (valid && rec_player_read_frame(&rec_player, &frame)) {
+        if (frame.time > start) {
+            uint64_t now, due;
+
+            now = get_time() / 1000;
+            due = origin + frame.time;
+
+            if (due > now) {
+                usleep((due - now) * 1000);
+            }
+        }
+
+        write(STDOUT_FILENO, frame.data, frame.size);
+    }
+
+    write(STDOUT_FILENO, "\e[0m\e[?25h\n", 11);
+    fclose(file);
+
+    if (!valid) {
+        fprintf(stderr, "%s: invalid recording\n", path);
+    }
+
+    return valid;
+}
+
+static void
+count_bytes(const void *buffer, size_t size, void *arg)
+{
+    uint64_t *nr_bytes = arg;
+
+    (void)buffer;
+
+    *nr_bytes += size;
+}
+
+/*
+ * Encode the cells of a world which an output updates.
+ */
+static void
+encode_span(const struct eetg_output *output, int row, int start, int end,
+            void *arg)
+{
+    struct wire_cell cells[EETG_MAX_COLUMNS], prev_cells[EETG_MAX_COLUMNS];
+
+    for (int column = start; column < end; column++) {
+        int color;
+
+        eetg_output_get_view_cell(output, row, column,
+                                  &cells[column].c, &color);
+        assert(color >= 0);
+        assert(color < WIRE_NR_COLORS);
+        cells[column].color = color;
+        eetg_output_get_cell(output, row, column,
+                             &prev_cells[column].c, &color);
+        prev_cells[column].color = color;
+    }
+
+    wire_encoder_add_row(arg, row, cells, prev_cells, start, end);
+}
+
+/*
+ * Encode the cells of a terminal model, as the compact protocol would
+ * send them.
+ *
+ * The model doesn't track changes, so that its cells are compared to
+ * those of the previous frame, kept in the given screen.
+ */
+static void
+encode_vt_frame(struct wire_encoder *encoder, const struct vt *frame_vt,
+                struct wire_screen *prev_screen, int nr_columns, int nr_rows)
+{
+    for (int row = 0; row < nr_rows; row++) {
+        struct wire_cell cells[EETG_MAX_COLUMNS];
+
+        for (int column = 0; column < nr_columns; column++) {
+            int color;
+
+            vt_get_cell(frame_vt, row, column, &cells[column].c, &color);
+            cells[column].color = color;
+        }
+
+        wire_encoder_add_row(encoder, row, cells, prev_screen->cells[row],
+                             0, nr_columns);
+        memcpy(prev_screen->cells[row], cells,
+               nr_columns * sizeof(cells[0]));
+    }
+
+    wire_encoder_end_frame(encoder);
+}
+
+/*
+ * Replay a recording through a terminal model, and report the bytes per
+ * frame of the compact protocol, compared to the recorded ANSI frames.
+ */
+static bool
+measure_recording(const char *path)
+{
+    struct wire_stats stats;
+    uint64_t nr_frame_bytes = 0, nr_wire_bytes = 0;
+    struct rec_frame frame;
+    int nr_columns = 0, nr_rows = 0;
+    FILE *file;
+    bool valid;
+
+    file = fopen(path, "rb");
+
+    if (!file) {
+        perror(path);
+        return false;
+    }
+
+    valid = rec_player_init(&rec_player, file);
+
+    if (valid) {
+        nr_columns = rec_player_get_nr_columns(&rec_player);
+        nr_rows = rec_player_get_nr_rows(&rec_player);
+        valid = (nr_columns <= EETG_MAX_COLUMNS)
+                && (nr_rows <= EETG_MAX_ROWS);
+    }
+
+    if (valid) {
+        vt_init(&vt, NULL, NULL);
+        vt_set_size(&vt, nr_columns, nr_rows);
+        wire_encoder_init(&wire, nr_columns, nr_rows,
+                          count_bytes, &nr_wire_bytes);
+
+        for (int row = 0; row < nr_rows; row++) {
+            for (int column = 0; column < nr_columns; column++) {
+                wire_prev_screen.cells[row][column].c = ' ';
+                wire_prev_screen.cells[row][column].color = 0;
+            }
+        }
+    }
+
+    while (valid && rec_player_read_frame(&rec_player, &frame)) {
+        vt_write(frame.data, frame.size, &vt);
+        nr_frame_bytes += frame.size;
+        encode_vt_frame(&wire, &vt, &wire_prev_screen, nr_columns, nr_rows);
+    }
+
+    fclose(file);
+
+    if (!valid) {
+        fprintf(stderr, "%s: invalid recording\n", path);
+        return false;
+    }
+
+    wire_encoder_get_stats(&wire, &stats);
+    report_wire_stats(&stats);
+
+    if (stats.nr_frames != 0) {
+        fprintf(stderr, "ANSI bytes: %llu, %.1f per frame\n",
+                (unsigned long long)nr_frame_bytes,
+                (double)nr_frame_bytes / stats.nr_frames);
+    }
+
+    return true;
+}
+
+/*
+ * Listen for viewers on the given TCP port, from the local host only,
+ * unless public.
+ */
+static int
+setup_cast(unsigned long port, bool public)
+{
+    struct sockaddr_in addr;
+    int fd, on = 1;
+
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (fd == -1) {
+        return -1;
+    }
+
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(public ? INADDR_ANY : INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+
+    if ((bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1)
+        || (listen(fd, CAST_MAX_VIEWERS) == -1)) {
+        close(fd);
+        return -1;
+    }
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    return fd;
+}
+
+static void
+accept_viewers(void)
+{
+    for (;;) {
+        int fd;
+
+        fd = accept(cast_fd, NULL, NULL);
+
+        if (fd == -1) {
+            break;
+        }
+
+        if (!cast_add_viewer(&cast, fd)) {
+            close(fd);
+        }
+    }
+}
+
+/*
+ * Connect to the remote peer, on the local host, either by waiting for
+ * the guest on the given port, or by joining the host listening on it.
+ */
+static int
+setup_peer(unsigned long port, bool host)
+{
+    struct sockaddr_in addr;
+    int fd, on = 1;
+
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (fd == -1) {
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+
+    if (host) {
+        int listen_fd = fd;
+
+        setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+        if ((bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) == -1)
+            || (listen(listen_fd, 1) == -1)) {
+            close(listen_fd);
+            return -1;
+        }
+
+        fd = accept(listen_fd, NULL, NULL);
+        close(listen_fd);
+
+        if (fd == -1) {
+            return -1;
+        }
+    } else if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        close(fd);
+        return -1;
+    }
+
+    /*
+     * Inputs are sent one at a time, and must not be delayed.
+     */
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+    return fd;
+}
+
+/*
+ * Run a lockstep tick, with the given local input.
+ *
+ * Return true if a player chose to leave, or if the peers can't go on.
+ */
+static bool
+process_lockstep(int8_t c)
+{
+    int8_t inputs[PEER_NR_PLAYERS];
+    bool leave;
+
+    if (!peer_send_input(&peer, c) || !peer_get_inputs(&peer, inputs)) {
+        return true;
+    }
+
+    leave = ei_game_process_inputs(&game, inputs, ARRAY_SIZE(inputs));
+
+    if (!peer_end_tick(&peer, ei_game_hash(&game))) {
+        return true;
+    }
+
+    return leave || peer_is_desynced(&peer, NULL);
+}
+
+/*
+ * Run two peers in lockstep over a local socket pair, both rendering
+ * their own game, with random inputs, for the given number of ticks.
+ *
+ * Report the traffic between peers, compared to the bytes rendered by
+ * each game, and return true if the peers remained in sync.
+ */
+static bool
+run_loopback(unsigned long nr_ticks, unsigned int delay)
+{
+    static const int8_t actions[] = { -1, -1, ' ', 's', 'f' };
+    uint64_t nr_frame_bytes[PEER_NR_PLAYERS] = { 0 };
+    struct peer_stats stats;
+    uint32_t seed, tick;
+    bool synced = true;
+    int fds[2];
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1) {
+        perror("socketpair");
+        return false;
+    }
+
+    seed = time(NULL);
+    srand(seed);
+
+    if (!peer_host(&loopback_peers[PEER_HOST], fds[0], delay, seed)
+        || !peer_join(&loopback_peers[PEER_GUEST], fds[1], &seed)) {
+        fprintf(stderr, "loopback: handshake failed\n");
+        return false;
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(loopback_games); i++) {
+        eetg_init_rand(seed);
+        ei_game_init(&loopback_games[i], count_bytes, &nr_frame_bytes[i]);
+    }
+
+    /*
+     * Inputs are sent by both peers before any of them waits for the
+     * inputs of the other, as they would from separate processes.
+     */
+    for (unsigned long i = 0; synced && (i < nr_ticks); i++) {
+        for (size_t j = 0; j < ARRAY_SIZE(loopback_peers); j++) {
+            int8_t c;
+
+            c = actions[rand() % ARRAY_SIZE(actions)];
+
+            if (!peer_send_input(&loopback_peers[j], c)) {
+                synced = false;
+            }
+        }
+
+        for (size_t j = 0; j < ARRAY_SIZE(loopback_peers); j++) {
+            struct peer *loopback_peer = &loopback_peers[j];
+            struct ei_game *loopback_game = &loopback_games[j];
+            int8_t inputs[PEER_NR_PLAYERS];
+
+            if (!peer_get_inputs(loopback_peer, inputs)) {
+                synced = false;
+                break;
+            }
+
+            ei_game_render(loopback_game);
+            ei_game_process_inputs(loopback_game, inputs, ARRAY_SIZE(inputs));
+
+            if (!peer_end_tick(loopback_peer, ei_game_hash(loopback_game))
+                || peer_is_desynced(loopback_peer, &tick)) {
+                synced = false;
+            }
+        }
+    }
+
+    peer_get_stats(&loopback_peers[PEER_HOST], &stats);
+
+    fprintf(stderr, "loopback ticks: %llu, input delay: %u, "
+                    "hash checks: %lu\n",
+            (unsigned long long)stats.nr_ticks, delay, stats.nr_checks);
+    fprintf(stderr, "lockstep bytes per peer: %llu, rendered bytes: %llu\n",
+            (unsigned long long)stats.nr_sent_bytes,
+            (unsigned long long)nr_frame_bytes[PEER_HOST]);
+
+    if (peer_is_desynced(&loopback_peers[PEER_HOST], &tick)
+        || peer_is_desynced(&loopback_peers[PEER_GUEST], &tick)) {
+        fprintf(stderr, "loopback desync at tick %lu\n",
+                (unsigned long)tick);
+    } else if (!synced) {
+        fprintf(stderr, "loopback: connection lost\n");
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(loopback_peers); i++) {
+        peer_destroy(&loopback_peers[i]);
+    }
+
+    return synced;
+}
+
+static void
+bench_handle_collision(struct eetg_object *object1,
+                       struct eetg_object *object2,
+                       int x, int y, void *arg)
+{
+    struct eetg_object *alien, *missile;
+
+    (void)x;
+    (void)y;
+    (void)arg;
+
+    if (eetg_object_get_type(object1) == BENCH_TYPE_MISSILE) {
+        missile = object1;
+        alien = object2;
+    } else {
+        missile = object2;
+        alien = object1;
+    }
+
+    /*
+     * An alien may be checked against other missiles once destroyed.
+     */
+    if ((eetg_object_get_type(missile) != BENCH_TYPE_MISSILE)
+        || (eetg_object_get_type(alien) != BENCH_TYPE_ALIEN)
+        || !eetg_object_get_world(alien)
+        || bench_missile_hits[missile - bench_missiles]) {
+        return;
+    }
+
+    eetg_object_remove_member(&bench_formation, alien);
+    bench_missile_hits[missile - bench_missiles] = true;
+    bench_nr_collisions++;
+}
+
+static void
+bench_fill_formation(int nr_aliens, int nr_aliens_per_row)
+{
+    eetg_object_init_compound(&bench_formation, BENCH_TYPE_FORMATION);
+
+    for (int i = 0; i < nr_aliens; i++) {
+        struct eetg_object *alien = &bench_aliens[i];
+        int x, y;
+
+        x = (i % nr_aliens_per_row) * BENCH_ALIEN_SPACING_X;
+        y = (i / nr_aliens_per_row) * BENCH_ALIEN_SPACING_Y;
+
+        eetg_object_init(alien, BENCH_TYPE_ALIEN, &bench_alien_sprite);
+        eetg_object_set_color(alien, EETG_COLOR_GREEN);
+        eetg_object_add_member(&bench_formation, alien, x, y);
+    }
+}
+
+static void
+bench_launch_missile(int index)
+{
+    struct eetg_object *missile = &bench_missiles[index];
+    int x, y;
+
+    x = (index * BENCH_MISSILE_SPACING)
+        + (eetg_world_rand(&bench_world) % BENCH_MISSILE_SPACING);
+    y = eetg_world_get_nr_rows(&bench_world) - 1;
+
+    bench_missile_hits[index] = false;
+
+    if (eetg_object_get_world(missile)) {
+        eetg_object_move(missile, x, y);
+    } else {
+        eetg_world_add(&bench_world, missile, x, y);
+    }
+}
+
+static int
+bench_follow(int position, int target, int size, int world_size)
+{
+    int margin;
+
+    margin = size / BENCH_PAN_DIVISOR;
+
+    if (target < (position + margin)) {
+        position -= margin;
+    } else if (target >= (position + size - margin)) {
+        position += margin;
+    }
+
+    if (position > (world_size - size)) {
+        position = world_size - size;
+    }
+
+    if (position < 0) {
+        position = 0;
+    }
+
+    return position;
+}
+
+/*
+ * Move the viewport so that it follows the middle of the lowest row of
+ * the formation.
+ */
+static void
+bench_move_viewport(void)
+{
+    const struct eetg_object *formation = &bench_formation;
+    int x, y;
+
+    x = eetg_object_get_x(formation) + (eetg_object_get_width(formation) / 2);
+    y = eetg_object_get_y(formation) + eetg_object_get_height(formation) - 1;
+
+    x = bench_follow(eetg_world_get_viewport_x(&bench_world), x,
+                     eetg_world_get_viewport_nr_columns(&bench_world),
+                     eetg_world_get_nr_columns(&bench_world));
+    y = bench_follow(eetg_world_get_viewport_y(&bench_world), y,
+                     eetg_world_get_viewport_nr_rows(&bench_world),
+                     eetg_world_get_nr_rows(&bench_world));
+
+    eetg_world_move_viewport(&bench_world, x, y);
+}
+
+/*
+ * Run a board of the given size for the given number of ticks, and
+ * report the time and bytes per tick.
+ *
+ * Each tick, a formation of aliens covering the upper half of the board
+ * moves by one column, bouncing off the sides, and a row of missiles
+ * moves up, each missile destroying the first alien it hits.
+ *
+ * If follow is true, the viewport is of the default size, and follows
+ * the formation.
+ */
+static void
+bench_run_board(int nr_columns, int nr_rows, bool follow,
+                unsigned long nr_ticks)
+{
+    uint64_t nr_bytes = 0, start, elapsed;
+    int nr_aliens, nr_aliens_per_row, nr_missiles, direction;
+
+    eetg_world_init(&bench_world, count_bytes, &nr_bytes);
+    eetg_world_set_size(&bench_world, nr_columns, nr_rows);
+
+    if (follow) {
+        eetg_world_resize_viewport(&bench_world, EETG_COLUMNS, EETG_ROWS);
+    }
+
+    eetg_world_register_collision_fn(&bench_world, bench_handle_collision,
+                                     NULL);
+
+    eetg_sprite_init(&bench_alien_sprite, "<o>\n");
+    eetg_sprite_init(&bench_missile_sprite, "|\n");
+
+    nr_aliens_per_row = (nr_columns * 3 / 4) / BENCH_ALIEN_SPACING_X;
+    nr_aliens = nr_aliens_per_row * ((nr_rows / 2) / BENCH_ALIEN_SPACING_Y);
+
+    if (nr_aliens > BENCH_MAX_ALIENS) {
+        nr_aliens = BENCH_MAX_ALIENS;
+    }
+
+    nr_missiles = nr_columns / BENCH_MISSILE_SPACING;
+
+    if (nr_missiles > BENCH_MAX_MISSILES) {
+        nr_missiles = BENCH_MAX_MISSILES;
+    }
+
+    bench_fill_formation(nr_aliens, nr_aliens_per_row);
+    eetg_world_add(&bench_world, &bench_formation, 0, 1);
+
+    for (int i = 0; i < nr_missiles; i++) {
+        eetg_object_init(&bench_missiles[i], BENCH_TYPE_MISSILE,
+                         &bench_missile_sprite);
+        eetg_object_set_color(&bench_missiles[i], EETG_COLOR_RED);
+        bench_launch_missile(i);
+    }
+
+    bench_nr_collisions = 0;
+    direction = 1;
+    start = get_time();
+
+    for (unsigned long tick = 0; tick < nr_ticks; tick++) {
+        struct eetg_object *formation = &bench_formation;
+        int x, y;
+
+        if (eetg_object_is_empty(formation)) {
+            eetg_world_remove(&bench_world, formation);
+            bench_fill_formation(nr_aliens, nr_aliens_per_row);
+            eetg_world_add(&bench_world, formation, 0, 1);
+        }
+
+        x = eetg_object_get_x(formation) + direction;
+        y = eetg_object_get_y(formation);
+
+        if ((x < 0)
+            || ((x + eetg_object_get_width(formation)) > nr_columns)) {
+            direction = -direction;
+            x = eetg_object_get_x(formation);
+            y = ((y + eetg_object_get_height(formation)) < (nr_rows - 2))
+                ? (y + 1)
+                : 1;
+        }
+
+        eetg_object_move(formation, x, y);
+
+        for (int i = 0; i < nr_missiles; i++) {
+            struct eetg_object *missile = &bench_missiles[i];
+
+            y = eetg_object_get_y(missile) - 1;
+
+            if (bench_missile_hits[i] || (y < 0)) {
+                bench_launch_missile(i);
+            } else {
+                eetg_object_move(missile, eetg_object_get_x(missile), y);
+            }
+        }
+
+        if (follow) {
+            bench_move_viewport();
+        }
+
+        eetg_world_render(&bench_world, false);
+    }
+
+    elapsed = get_time() - start;
+
+    fprintf(stderr, "%4dx%-3d %7d cells %5d aliens: %9.1f us/tick, "
+                    "%8.1f bytes/tick, %lu hits%s\n",
+            nr_columns, nr_rows, nr_columns * nr_rows, nr_aliens,
+            (double)elapsed / nr_ticks,
+            (double)nr_bytes / nr_ticks, bench_nr_collisions,
+            follow ? ", viewport" : "");
+}
+
+/*
+ * Run synthetic boards of increasing size, up to the size limits of
+ * viewports, then the largest board behind a viewport of the default
+ * size, which only displays part of it.
+ */
+static void
+run_benchmark(unsigned long nr_ticks)
+{
+    int prev_nr_columns = 0, prev_nr_rows = 0;
+
+    eetg_init_rand(1);
+
+    for (int scale = 1; scale <= BENCH_NR_SCALES; scale++) {
+        int nr_columns, nr_rows;
+
+        nr_columns = EETG_COLUMNS * scale;
+        nr_rows = EETG_ROWS * scale;
+
+        if (nr_columns > EETG_MAX_COLUMNS) {
+            nr_columns = EETG_MAX_COLUMNS;
+        }
+
+        if (nr_rows > EETG_MAX_ROWS) {
+            nr_rows = EETG_MAX_ROWS;
+        }
+
+        if ((nr_columns == prev_nr_columns) && (nr_rows == prev_nr_rows)) {
+            break;
+        }
+
+        bench_run_board(nr_columns, nr_rows, false, nr_ticks);
+
+        prev_nr_columns = nr_columns;
+        prev_nr_rows = nr_rows;
+    }
+
+    if ((prev_nr_columns != EETG_MAX_COLUMNS)
+        || (prev_nr_rows != EETG_MAX_ROWS)) {
+        bench_run_board(EETG_MAX_COLUMNS, EETG_MAX_ROWS, false, nr_ticks);
+    }
+
+    if (!EETG_FIXED_SIZE) {
+        bench_run_board(EETG_COLUMNS * BENCH_NR_SCALES,
+                        EETG_ROWS * BENCH_NR_SCALES, true, nr_ticks);
+    }
+}
+
+static void
+render_frame(void)
+{
+    if (uart_enabled) {
+        if (uart_mode == UART_MODE_BACKPRESSURE) {
+            size_t room;
+
+            room = uart_get_room(&uart);
+
+            /*
+             * Frames are skipped while the link is busy, and their
+             * changes are rendered with the next frame.
+             */
+            if (room < uart_frame_room) {
+                return;
+            }
+
+            eetg_world_set_byte_budget(&game.world, room);
+        }
+
+        uart_start_frame(&uart);
+    }
+
+    ei_game_render(&game);
+
+    if (vt_enabled) {
+        size_t nr_mismatches;
+
+        nr_mismatches = vt_check(&vt, eetg_world_get_output(&game.world));
+        assert(nr_mismatches == 0);
+        (void)nr_mismatches;
+    }
+
+    if (uart_enabled) {
+        uart_end_frame(&uart);
+    }
+
+    if (cast_enabled) {
+        cast_end_frame(&cast, &game.world);
+    }
+
+    if (rec_file) {
+        rec_end_frame(&rec, &game.world,
+                      (get_time() - rec_start_time) / 1000);
+    }
+
+    if (wire_enabled) {
+        wire_encoder_end_frame(&wire);
+    }
+}
+
+/*
+ * Parse a decimal number, which must be within the given range.
+ *
+ * Return false if the string isn't entirely a number, or if the number
+ * is out of range.
+ */
+static bool
+parse_number(const char *str, unsigned long min, unsigned long max,
+             unsigned long *value)
+{
+    unsigned long number;
+    char *end;
+
+    assert(str);
+    assert(value);
+
+    /*
+     * Unlike strtoul, reject leading white space and signs.
+     */
+    if ((*str < '0') || (*str > '9')) {
+        return false;
+    }
+
+    errno = 0;
+    number = strtoul(str, &end, 10);
+
+    if ((errno != 0) || (*end != '\0') || (number < min) || (number > max)) {
+        return false;
+    }
+
+    *value = number;
+    return true;
+}
+
+static void
+usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-r render_rate] "
+                    "[-b baud_rate [-q fifo_size] [-n]] [-a [-j threads]] "
+                    "[-s] [-v] [-w port [-g]] [{-l|-c} port [-d delay]] "
+                    "[-t ticks] [-f file] [-p file [-o seconds]] [-e] "
+                    "[-m file] [-k ticks]\n"
+                    "  -r  frames per second, up to %d\n"
+                    "  -b  emulate a serial link at the given baud rate\n"
+                    "  -q  transmit FIFO depth, in bytes\n"
+                    "  -n  don't block on a full FIFO, limit frames "
+                    "to the room left, or skip them, instead\n"
+                    "  -a  let the autoplayer play, 'x' still leaves\n"
+                    "  -j  number of autoplayer threads, up to %d, "
+                    "default one per core\n"
+                    "  -s  run on the alternate screen, with synchronized "
+                    "updates\n"
+                    "  -v  check the output against a terminal model, "
+                    "and report bytes per sequence class\n"
+                    "  -w  broadcast the game to viewers connecting "
+                    "to the given local TCP port\n"
+                    "  -g  accept viewers from any host, not only the "
+                    "local host\n"
+                    "  -l  host a two-player game in lockstep, waiting "
+                    "for the guest on\n"
+                    "      the given local TCP port\n"
+                    "  -c  join a two-player game hosted on the given "
+                    "local TCP port\n"
+                    "  -d  input delay of the host, in ticks, up to %d, "
+                    "default %d\n"
+                    "  -t  run two peers in lockstep over a local socket "
+                    "for the given\n"
+                    "      number of ticks, with random inputs, and "
+                    "check they remain in sync\n"
+                    "  -f  record the session to the given file\n"
+                    "  -p  play the given recording\n"
+                    "  -o  start playing at the given time, in seconds\n"
+                    "  -e  write the compact frame protocol to the standard "
+                    "output, for\n"
+                    "      embedded_invaders_client, and report bytes "
+                    "per frame\n"
+                    "  -m  report the bytes per frame of the given recording "
+                    "with the\n"
+                    "      compact frame protocol\n"
+                    "  -k  run synthetic boards of increasing size, up to "
+                    "the size limits\n"
+                    "      of viewports, then a board larger than its "
+                    "viewport, for the given\n"
+                    "      number of ticks, and report the cost per tick\n",
+            name, EI_TICK_RATE, BOT_MAX_THREADS, PEER_MAX_DELAY,
+            PEER_DEFAULT_DELAY);
+}
+
 int
-main(void)
+main(int argc, char *argv[])
 {
+    unsigned long render_rate = EI_TICK_RATE;
+    unsigned long render_credit;
+    unsigned long baud_rate = 0;
+    unsigned long fifo_size = 0;
+    unsigned long nr_threads = 0;
+    unsigned long port = 0;
+    unsigned long peer_port = 0;
+    unsigned long delay = PEER_DEFAULT_DELAY;
+    unsigned long nr_loopback_ticks = 0;
+    unsigned long nr_bench_ticks = 0;
+    const char *rec_path = NULL;
+    const char *play_path = NULL;
+    const char *measure_path = NULL;
+    unsigned long play_start = 0;
+    bool host = false;
+    bool cast_public = false;
+    bool autoplay = false;
+    eetg_write_fn write_fn;
+    void *write_fn_arg;
+    uint32_t seed;
     bool leave;
+    int opt;
+
+    while ((opt = getopt(argc, argv,
+                         "r:b:q:naj:svw:gl:c:d:t:f:p:o:em:k:")) != -1) {
+        bool valid = true;
+
+        switch (opt) {
+        case 'r':
+            valid = parse_number(optarg, 1, EI_TICK_RATE, &render_rate);
+            break;
+        case 'b':
+            valid = parse_number(optarg, 1, ULONG_MAX, &baud_rate);
+            break;
+        case 'q':
+            valid = parse_number(optarg, 1, SIZE_MAX, &fifo_size);
+            break;
+        case 'n':
+            uart_mode = UART_MODE_BACKPRESSURE;
+            break;
+        case 'a':
+            autoplay = true;
+            break;
+        case 'j':
+            valid = parse_number(optarg, 1, BOT_MAX_THREADS, &nr_threads);
+            break;
+        case 's':
+            session_enabled = true;
+            break;
+        case 'v':
+            vt_enabled = true;
+            break;
+        case 'w':
+            valid = parse_number(optarg, 1, UINT16_MAX, &port);
+            cast_enabled = true;
+            break;
+        case 'g':
+            cast_public = true;
+            break;
+        case 'l':
+        case 'c':
+            valid = parse_number(optarg, 1, UINT16_MAX, &peer_port);
+            peer_enabled = true;
+            host = (opt == 'l');
+            break;
+        case 'd':
+            valid = parse_number(optarg, 0, PEER_MAX_DELAY, &delay);
+            break;
+        case 't':
+            valid = parse_number(optarg, 1, ULONG_MAX, &nr_loopback_ticks);
+            break;
+        case 'f':
+            rec_path = optarg;
+            break;
+        case 'p':
+            play_path = optarg;
+            break;
+        case 'o':
+            valid = parse_number(optarg, 0, UINT32_MAX / 1000, &play_start);
+            break;
+        case 'e':
+            wire_enabled = true;
+            break;
+        case 'm':
+            measure_path = optarg;
+            break;
+        case 'k':
+            valid = parse_number(optarg, 1, ULONG_MAX, &nr_bench_ticks);
+            break;
+        default:
+            valid = false;
+        }
+
+        if (!valid) {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    /*
+     * The compact protocol replaces the terminal sequences these options
+     * operate on.
+     */
+    if (wire_enabled
+        && (session_enabled || vt_enabled || cast_enabled || rec_path
+            || (baud_rate != 0))) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (nr_loopback_ticks != 0) {
+        return run_loopback(nr_loopback_ticks, delay)
+               ? EXIT_SUCCESS
+               : EXIT_FAILURE;
+    }
+
+    if (nr_bench_ticks != 0) {
+        run_benchmark(nr_bench_ticks);
+        return EXIT_SUCCESS;
+    }
+
+    if (play_path) {
+        return play_recording(play_path, play_start * 1000)
+               ? EXIT_SUCCESS
+               : EXIT_FAILURE;
+    }
+
+    if (measure_path) {
+        return measure_recording(measure_path) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    write_fn = write_terminal;
+    write_fn_arg = NULL;
+
+    if (baud_rate != 0) {
+        if (fifo_size == 0) {
+            fifo_size = baud_rate / 10 / render_rate;
+
+            if (fifo_size < UART_MIN_FIFO_SIZE) {
+                fifo_size = UART_MIN_FIFO_SIZE;
+            }
+        }
+
+        uart_init(&uart, baud_rate, fifo_size, uart_mode,
+                  1000000 / render_rate, write_fn, write_fn_arg);
+        uart_frame_room = (fifo_size < UART_MIN_FRAME_ROOM)
+                          ? fifo_size
+                          : UART_MIN_FRAME_ROOM;
+        uart_enabled = true;
+        atexit(report_uart_stats);
+
+        write_fn = uart_write;
+        write_fn_arg = &uart;
+    }
+
+    /*
+     * The terminal model sees the frames as they're produced, before
+     * the serial link, if any.
+     */
+    if (vt_enabled) {
+        vt_init(&vt, write_fn, write_fn_arg);
+        atexit(report_vt_stats);
+
+        write_fn = vt_write;
+        write_fn_arg = &vt;
+    }
+
+    /*
+     * Viewers receive the frames as produced by the world.
+     */
+    if (cast_enabled) {
+        cast_fd = setup_cast(port, cast_public);
+
+        if (cast_fd == -1) {
+            perror("broadcast");
+            return EXIT_FAILURE;
+        }
+
+        cast_init(&cast, write_fn, write_fn_arg);
+        atexit(report_cast_stats);
+
+        write_fn = cast_write;
+        write_fn_arg = &cast;
+    }
+
+    /*
+     * Recordings also capture the frames as produced by the world.
+     */
+    if (rec_path) {
+        rec_file = fopen(rec_path, "wb");
+
+        if (!rec_file) {
+            perror(rec_path);
+            return EXIT_FAILURE;
+        }
+
+        rec_init(&rec, rec_file, write_fn, write_fn_arg);
+
+        rec_start_time = get_time();
+        atexit(close_recording);
+
+        write_fn = rec_write;
+        write_fn_arg = &rec;
+    }
+
+    seed = time(NULL);
+
+    /*
+     * Both peers start from the seed of the host.
+     */
+    if (peer_enabled) {
+        int fd;
+        bool ok;
+
+        fd = setup_peer(peer_port, host);
+
+        if (fd == -1) {
+            perror("lockstep");
+            return EXIT_FAILURE;
+        }
+
+        ok = host ? peer_host(&peer, fd, delay, seed)
+                  : peer_join(&peer, fd, &seed);
+
+        if (!ok) {
+            fprintf(stderr, "lockstep: handshake failed\n");
+            return EXIT_FAILURE;
+        }
+
+        atexit(report_peer_stats);
+    }
 
     setup_io();
 
-    eetg_init_rand(time(NULL));
+    eetg_init_rand(seed);
+
+    ei_game_init(&game, write_fn, write_fn_arg);
+
+    if (write_fn == write_terminal) {
+        eetg_world_set_writev_fn(&game.world, writev_terminal);
+    }
+
+    /*
+     * The terminal model and the encoder cover the viewport of the game.
+     */
+    if (vt_enabled) {
+        vt_set_size(&vt, eetg_world_get_viewport_nr_columns(&game.world),
+                    eetg_world_get_viewport_nr_rows(&game.world));
+    }
+
+    /*
+     * With the compact protocol, the world reports the cells it updates
+     * to the encoder instead of writing terminal sequences.
+     */
+    if (wire_enabled) {
+        wire_encoder_init(&wire,
+                          eetg_world_get_viewport_nr_columns(&game.world),
+                          eetg_world_get_viewport_nr_rows(&game.world),
+                          write_terminal, NULL);
+        atexit(report_wire_encoder_stats);
+        eetg_output_set_span_fn(eetg_world_get_output(&game.world),
+                                encode_span, &wire);
+    }
+
+    if (session_enabled) {
+        eetg_world_start_session(&game.world, EETG_OUTPUT_SYNC_UPDATE
+                                              | EETG_OUTPUT_ALT_SCREEN);
+    }
+
+    if (autoplay) {
+        /*
+         * Rollouts are spread over all cores by default.
+         */
+        if (nr_threads == 0) {
+            long nr_cpus;
+
+            nr_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+            if (nr_cpus < 1) {
+                nr_threads = 1;
+            } else if (nr_cpus > BOT_MAX_THREADS) {
+                nr_threads = BOT_MAX_THREADS;
+            } else {
+                nr_threads = nr_cpus;
+            }
+        }
+
+        bot_init(&bot, BOT_DEFAULT_NR_ROLLOUTS, BOT_DEFAULT_DEPTH,
+                 nr_threads, time(NULL));
+        atexit(stop_bot);
+        atexit(report_bot_stats);
+    }
 
-    ei_game_init(&game, write_terminal, NULL);
+    /*
+     * Frames are spread as evenly as possible over simulation ticks,
+     * starting with the first one.
+     */
+    render_credit = EI_TICK_RATE - render_rate;
 
     do {
         ssize_t nr_bytes;
         int8_t c;
 
-        usleep(1000000 / EI_FPS);
+        usleep(1000000 / EI_TICK_RATE);
 
         nr_bytes = read(STDIN_FILENO, &c, 1);
 
@@ -91,7 +1474,31 @@ main(void)
             }
         }
 
-        leave = ei_game_process(&game, c);
+        if (cast_enabled) {
+            accept_viewers();
+            cast_flush(&cast);
+        }
+
+        if (autoplay && (c != 'x')) {
+            uint64_t start;
+
+            start = get_time();
+            c = bot_select(&bot, &game);
+            bot_elapsed += get_time() - start;
+        }
+
+        render_credit += render_rate;
+
+        if (render_credit >= EI_TICK_RATE) {
+            render_credit -= EI_TICK_RATE;
+            render_frame();
+        }
+
+        if (peer_enabled) {
+            leave = process_lockstep(c);
+        } else {
+            leave = ei_game_process(&game, c);
+        }
     } while (!leave);
 
     return EXIT_SUCCESS;
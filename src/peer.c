@@ -0,0 +1,398 @@
+/*
+ * Copyright (c) 2024 Richard Braun.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS” AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE
+ * FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY
+ * DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *
+ * Lockstep multiplayer.
+ *
+ * Messages:
+ *  - hello, from the host: "EIL", version, input delay, seed
+ *  - input: the input character, or PEER_MSG_NO_INPUT
+ *  - hash: PEER_MSG_HASH, tick, hash
+ *
+ * Integers are sent in big-endian byte order.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "macros.h"
+#include "peer.h"
+
+#define PEER_MAGIC          "EIL"
+#define PEER_VERSION        1
+#define PEER_HELLO_SIZE     9
+
+#define PEER_MSG_HASH       0xfe
+#define PEER_MSG_NO_INPUT   0xff
+#define PEER_HASH_MSG_SIZE  9
+
+static void
+peer_write32(uint8_t *buffer, uint32_t value)
+{
+    buffer[0] = value >> 24;
+    buffer[1] = value >> 16;
+    buffer[2] = value >> 8;
+    buffer[3] = value;
+}
+
+static uint32_t
+peer_read32(const uint8_t *buffer)
+{
+    return ((uint32_t)buffer[0] << 24) | ((uint32_t)buffer[1] << 16)
+           | ((uint32_t)buffer[2] << 8) | buffer[3];
+}
+
+static void
+peer_init(struct peer *peer, int fd, int index, unsigned int delay)
+{
+    assert(peer);
+    assert(fd != -1);
+    assert(delay <= PEER_MAX_DELAY);
+
+    peer->fd = fd;
+    peer->index = index;
+    peer->delay = delay;
+    peer->tick = 0;
+
+    /*
+     * There are no inputs for the ticks before the first ones sent.
+     */
+    peer->nr_remote_inputs = delay;
+
+    for (size_t i = 0; i < ARRAY_SIZE(peer->inputs); i++) {
+        memset(peer->inputs[i], PEER_NO_INPUT, sizeof(peer->inputs[i]));
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(peer->local_hashes); i++) {
+        peer->local_hashes[i].valid = false;
+        peer->remote_hashes[i].valid = false;
+    }
+
+    peer->rx_size = 0;
+    peer->desynced = false;
+    peer->desync_tick = 0;
+
+    memset(&peer->stats, 0, sizeof(peer->stats));
+}
+
+static bool
+peer_send(struct peer *peer, const void *buffer, size_t size)
+{
+    const char *ptr = buffer;
+
+    assert(peer);
+
+    while (size != 0) {
+        ssize_t nr_bytes;
+
+        nr_bytes = send(peer->fd, ptr, size, MSG_NOSIGNAL);
+
+        if (nr_bytes == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return false;
+        }
+
+        peer->stats.nr_sent_bytes += nr_bytes;
+        ptr += nr_bytes;
+        size -= nr_bytes;
+    }
+
+    return true;
+}
+
+static void
+peer_check_hash(struct peer *peer, size_t slot)
+{
+    struct peer_hash *local, *remote;
+
+    assert(peer);
+    assert(slot < ARRAY_SIZE(peer->local_hashes));
+
+    local = &peer->local_hashes[slot];
+    remote = &peer->remote_hashes[slot];
+
+    if (!local->valid || !remote->valid || (local->tick != remote->tick)) {
+        return;
+    }
+
+    peer->stats.nr_checks++;
+
+    if ((local->hash != remote->hash) && !peer->desynced) {
+        peer->desynced = true;
+        peer->desync_tick = local->tick;
+    }
+
+    remote->valid = false;
+}
+
+static size_t
+peer_get_hash_slot(uint32_t tick)
+{
+    return (tick / PEER_HASH_INTERVAL) % PEER_NR_HASHES;
+}
+
+/*
+ * Process the complete messages in the receive buffer.
+ */
+static bool
+peer_parse(struct peer *peer)
+{
+    size_t i = 0;
+
+    assert(peer);
+
+    while (i < peer->rx_size) {
+        const uint8_t *msg = &peer->rx_buffer[i];
+
+        if (msg[0] == PEER_MSG_HASH) {
+            struct peer_hash *hash;
+            uint32_t tick;
+            size_t slot;
+
+            if ((peer->rx_size - i) < PEER_HASH_MSG_SIZE) {
+                break;
+            }
+
+            tick = peer_read32(&msg[1]);
+            slot = peer_get_hash_slot(tick);
+            hash = &peer->remote_hashes[slot];
+            hash->tick = tick;
+            hash->hash = peer_read32(&msg[5]);
+            hash->valid = true;
+            peer_check_hash(peer, slot);
+
+            i += PEER_HASH_MSG_SIZE;
+        } else {
+            uint32_t index;
+
+            if ((msg[0] != PEER_MSG_NO_INPUT) && (msg[0] > INT8_MAX)) {
+                return false;
+            }
+
+            /*
+             * A well-behaved peer can't be this far ahead.
+             */
+            if ((peer->nr_remote_inputs - peer->tick) >= PEER_QUEUE_SIZE) {
+                return false;
+            }
+
+            index = peer->nr_remote_inputs % PEER_QUEUE_SIZE;
+            peer->inputs[!peer->index][index] = (msg[0] == PEER_MSG_NO_INPUT)
+                                                ? PEER_NO_INPUT
+                                                : (int8_t)msg[0];
+            peer->nr_remote_inputs++;
+
+            i++;
+        }
+    }
+
+    memmove(peer->rx_buffer, &peer->rx_buffer[i], peer->rx_size - i);
+    peer->rx_size -= i;
+
+    return true;
+}
+
+static bool
+peer_receive(struct peer *peer, bool wait)
+{
+    ssize_t nr_bytes;
+
+    assert(peer);
+    assert(peer->rx_size < sizeof(peer->rx_buffer));
+
+    nr_bytes = recv(peer->fd, &peer->rx_buffer[peer->rx_size],
+                    sizeof(peer->rx_buffer) - peer->rx_size,
+                    wait ? 0 : MSG_DONTWAIT);
+
+    if (nr_bytes == -1) {
+        return (errno == EINTR)
+               || (!wait && ((errno == EAGAIN) || (errno == EWOULDBLOCK)));
+    } else if (nr_bytes == 0) {
+        return false;
+    }
+
+    peer->stats.nr_received_bytes += nr_bytes;
+    peer->rx_size += nr_bytes;
+
+    return peer_parse(peer);
+}
+
+bool
+peer_host(struct peer *peer, int fd, unsigned int delay, uint32_t seed)
+{
+    uint8_t hello[PEER_HELLO_SIZE];
+
+    peer_init(peer, fd, PEER_HOST, delay);
+
+    memcpy(hello, PEER_MAGIC, 3);
+    hello[3] = PEER_VERSION;
+    hello[4] = delay;
+    peer_write32(&hello[5], seed);
+
+    return peer_send(peer, hello, sizeof(hello));
+}
+
+bool
+peer_join(struct peer *peer, int fd, uint32_t *seed)
+{
+    uint8_t hello[PEER_HELLO_SIZE];
+    size_t size = 0;
+
+    assert(seed);
+
+    while (size < sizeof(hello)) {
+        ssize_t nr_bytes;
+
+        nr_bytes = recv(fd, &hello[size], sizeof(hello) - size, 0);
+
+        if (nr_bytes == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            break;
+        } else if (nr_bytes == 0) {
+            break;
+        }
+
+        size += nr_bytes;
+    }
+
+    if ((size < sizeof(hello))
+        || (memcmp(hello, PEER_MAGIC, 3) != 0)
+        || (hello[3] != PEER_VERSION)
+        || (hello[4] > PEER_MAX_DELAY)) {
+        peer->fd = fd;
+        return false;
+    }
+
+    peer_init(peer, fd, PEER_GUEST, hello[4]);
+    peer->stats.nr_received_bytes = size;
+    *seed = peer_read32(&hello[5]);
+
+    return true;
+}
+
+void
+peer_destroy(struct peer *peer)
+{
+    assert(peer);
+
+    close(peer->fd);
+    peer->fd = -1;
+}
+
+bool
+peer_send_input(struct peer *peer, int8_t c)
+{
+    uint8_t msg;
+
+    assert(peer);
+
+    peer->inputs[peer->index][(peer->tick + peer->delay) % PEER_QUEUE_SIZE]
+        = (c < 0) ? PEER_NO_INPUT : c;
+
+    msg = (c < 0) ? PEER_MSG_NO_INPUT : (uint8_t)c;
+    return peer_send(peer, &msg, sizeof(msg));
+}
+
+bool
+peer_get_inputs(struct peer *peer, int8_t inputs[PEER_NR_PLAYERS])
+{
+    assert(peer);
+    assert(inputs);
+
+    if (peer->nr_remote_inputs <= peer->tick) {
+        if (!peer_receive(peer, false)) {
+            return false;
+        }
+
+        if (peer->nr_remote_inputs <= peer->tick) {
+            peer->stats.nr_stalls++;
+        }
+
+        while (peer->nr_remote_inputs <= peer->tick) {
+            if (!peer_receive(peer, true)) {
+                return false;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < PEER_NR_PLAYERS; i++) {
+        inputs[i] = peer->inputs[i][peer->tick % PEER_QUEUE_SIZE];
+    }
+
+    return true;
+}
+
+bool
+peer_end_tick(struct peer *peer, uint32_t hash)
+{
+    bool sent = true;
+
+    assert(peer);
+
+    if ((peer->tick % PEER_HASH_INTERVAL) == 0) {
+        uint8_t msg[PEER_HASH_MSG_SIZE];
+        struct peer_hash *local;
+        size_t slot;
+
+        slot = peer_get_hash_slot(peer->tick);
+        local = &peer->local_hashes[slot];
+        local->tick = peer->tick;
+        local->hash = hash;
+        local->valid = true;
+        peer_check_hash(peer, slot);
+
+        msg[0] = PEER_MSG_HASH;
+        peer_write32(&msg[1], peer->tick);
+        peer_write32(&msg[5], hash);
+        sent = peer_send(peer, msg, sizeof(msg));
+    }
+
+    peer->tick++;
+    peer->stats.nr_ticks++;
+
+    return sent;
+}
+
+bool
+peer_is_desynced(const struct peer *peer, uint32_t *tick)
+{
+    assert(peer);
+
+    if (peer->desynced && tick) {
+        *tick = peer->desync_tick;
+    }
+
+    return peer->desynced;
+}
+
+void
+peer_get_stats(const struct peer *peer, struct peer_stats *stats)
+{
+    assert(peer);
+    assert(stats);
+
+    *stats = peer->stats;
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2024 Richard Braun.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS” AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE
+ * FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY
+ * DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *
+ * Lockstep multiplayer.
+ *
+ * Two peers run the same deterministic simulation from the same seed,
+ * and only exchange their inputs, one byte per tick, over a stream
+ * socket. The input read on a tick is applied by both peers a fixed
+ * number of ticks later, the input delay, which gives it time to reach
+ * the remote peer. A tick is only simulated once the inputs of both
+ * peers for that tick are known, so that peers never drift apart by
+ * more than the input delay.
+ *
+ * The host chooses the seed and input delay, and sends them to the
+ * guest when the connection is established. Peers also exchange a hash
+ * of their state at regular intervals, so that a desync, i.e. peers
+ * which diverged, is detected.
+ *
+ * Inputs are characters between 0 and 127, or PEER_NO_INPUT.
+ */
+
+#ifndef PEER_H
+#define PEER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define PEER_HOST           0
+#define PEER_GUEST          1
+#define PEER_NR_PLAYERS     2
+
+#define PEER_NO_INPUT       -1
+
+/*
+ * Default and maximum input delays, in ticks.
+ */
+#define PEER_DEFAULT_DELAY  3
+#define PEER_MAX_DELAY      16
+
+/*
+ * Number of inputs buffered per player.
+ *
+ * A remote peer is at most the input delay ahead, and sends its inputs
+ * another input delay ahead of the tick it simulates.
+ */
+#define PEER_QUEUE_SIZE     64
+
+/*
+ * Interval, in ticks, between state hashes.
+ *
+ * Since peers drift apart by at most the input delay, the hashes of a
+ * few intervals are enough to compare them.
+ */
+#define PEER_HASH_INTERVAL  50
+#define PEER_NR_HASHES      4
+
+#define PEER_RX_BUFFER_SIZE 256
+
+struct peer_hash {
+    uint32_t tick;
+    uint32_t hash;
+    bool valid;
+};
+
+struct peer_stats {
+    uint64_t nr_ticks;
+    unsigned long nr_stalls;
+    unsigned long nr_checks;
+    uint64_t nr_sent_bytes;
+    uint64_t nr_received_bytes;
+};
+
+struct peer {
+    int fd;
+    int index;
+    unsigned int delay;
+    uint32_t tick;
+    uint32_t nr_remote_inputs;
+    int8_t inputs[PEER_NR_PLAYERS][PEER_QUEUE_SIZE];
+    struct peer_hash local_hashes[PEER_NR_HASHES];
+    struct peer_hash remote_hashes[PEER_NR_HASHES];
+    uint8_t rx_buffer[PEER_RX_BUFFER_SIZE];
+    size_t rx_size;
+    bool desynced;
+    uint32_t desync_tick;
+    struct peer_stats stats;
+};
+
+/*
+ * Start a lockstep session as the host, on a connected socket, with the
+ * given input delay, in ticks, and seed.
+ *
+ * The peer takes ownership of the socket, which is closed on destruction,
+ * even on error. Return false on error.
+ */
+bool peer_host(struct peer *peer, int fd, unsigned int delay, uint32_t seed);
+
+/*
+ * Join a lockstep session as the guest, on a connected socket.
+ *
+ * The seed chosen by the host is returned. The peer takes ownership of
+ * the socket, which is closed on destruction, even on error. Return false
+ * on error.
+ */
+bool peer_join(struct peer *peer, int fd, uint32_t *seed);
+
+/*
+ * Close the socket of a peer.
+ */
+void peer_destroy(struct peer *peer);
+
+/*
+ * Send the local input read on the current tick.
+ *
+ * The input is applied input delay ticks later. Return false if the
+ * remote peer left.
+ */
+bool peer_send_input(struct peer *peer, int8_t c);
+
+/*
+ * Get the inputs of both players for the current tick, indexed by
+ * player, waiting for those of the remote peer if needed.
+ *
+ * Return false if the remote peer left, or sent invalid data.
+ */
+bool peer_get_inputs(struct peer *peer, int8_t inputs[PEER_NR_PLAYERS]);
+
+/*
+ * End the current tick, with the hash of the resulting state.
+ *
+ * Return false if the remote peer left.
+ */
+bool peer_end_tick(struct peer *peer, uint32_t hash);
+
+/*
+ * Return true if peers diverged, along with the first tick for which
+ * hashes differ.
+ */
+bool peer_is_desynced(const struct peer *peer, uint32_t *tick);
+
+void peer_get_stats(const struct peer *peer, struct peer_stats *stats);
+
+#endif /* PEER_H */
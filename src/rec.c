@@ -0,0 +1,888 @@
+/*
+ * Copyright (c) 2024 Richard Braun.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS” AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE
+ * FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY
+ * DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *
+ * Session recording.
+ *
+ * File layout:
+ *  - header: "EIRC", version, rows, columns
+ *  - records: time and type, compressed size, compressed data
+ *  - index: keyframe offsets
+ *  - trailer: index offset, index size, "EIRX"
+ *
+ * The time of a keyframe is absolute, and the time of a delta frame is
+ * relative to the previous frame. It's shifted left by one bit, with the
+ * type in the least significant bit. Record fields are variable-length
+ * integers, 7 bits per byte, least significant first, with the high bit
+ * set on all bytes but the last. Header sizes are 16-bit, and index and
+ * trailer fields 32-bit, little-endian integers.
+ *
+ * Compressed data are sequences of literals followed by a match, each
+ * starting with a token, giving the number of literals in its high
+ * nibble, and the length of the match minus REC_MIN_MATCH in its low
+ * nibble. A nibble of 15 is followed by bytes adding to it, as long as
+ * they're 255. The literals follow, and then the match distance, in two
+ * bytes, little-endian. The last sequence has no match.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "eetg.h"
+#include "macros.h"
+#include "rec.h"
+
+#define REC_MAGIC           "EIRC"
+#define REC_INDEX_MAGIC     "EIRX"
+#define REC_VERSION         2
+#define REC_HEADER_SIZE     9
+#define REC_TRAILER_SIZE    12
+
+#define REC_TYPE_DELTA      0
+#define REC_TYPE_KEYFRAME   1
+
+#define REC_MIN_MATCH           4
+#define REC_MAX_DISTANCE        UINT16_MAX
+#define REC_MAX_CHAIN_LENGTH    32
+
+static void
+rec_write16(uint8_t *buffer, uint16_t value)
+{
+    buffer[0] = value;
+    buffer[1] = value >> 8;
+}
+
+static uint16_t
+rec_read16(const uint8_t *buffer)
+{
+    return buffer[0] | (buffer[1] << 8);
+}
+
+static void
+rec_write32(uint8_t *buffer, uint32_t value)
+{
+    buffer[0] = value;
+    buffer[1] = value >> 8;
+    buffer[2] = value >> 16;
+    buffer[3] = value >> 24;
+}
+
+static uint32_t
+rec_read32(const uint8_t *buffer)
+{
+    return buffer[0] | ((uint32_t)buffer[1] << 8)
+           | ((uint32_t)buffer[2] << 16) | ((uint32_t)buffer[3] << 24);
+}
+
+static size_t
+rec_encode_varint(uint8_t *buffer, uint32_t value)
+{
+    size_t size = 0;
+
+    while (value >= 0x80) {
+        buffer[size] = (value & 0x7f) | 0x80;
+        value >>= 7;
+        size++;
+    }
+
+    buffer[size] = value;
+    return size + 1;
+}
+
+static bool
+rec_read_varint(FILE *file, uint32_t *value, uint32_t *offset)
+{
+    *value = 0;
+
+    for (unsigned int shift = 0; shift < 32; shift += 7) {
+        int byte;
+
+        byte = getc(file);
+
+        if (byte == EOF) {
+            return false;
+        }
+
+        (*offset)++;
+        *value |= (uint32_t)(byte & 0x7f) << shift;
+
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static uint32_t
+rec_hash(const uint8_t *data)
+{
+    return (rec_read32(data) * 2654435761U) >> 20;
+}
+
+static size_t
+rec_encode_length(uint8_t *buffer, size_t length)
+{
+    size_t size = 0;
+
+    while (length >= 255) {
+        buffer[size] = 255;
+        length -= 255;
+        size++;
+    }
+
+    buffer[size] = length;
+    return size + 1;
+}
+
+static size_t
+rec_encode_sequence(uint8_t *buffer, const uint8_t *literals,
+                    size_t nr_literals, size_t distance, size_t length)
+{
+    size_t size = 1;
+    uint8_t token;
+
+    token = (nr_literals < 15) ? nr_literals : 15;
+    token <<= 4;
+
+    if (distance != 0) {
+        length -= REC_MIN_MATCH;
+        token |= (length < 15) ? length : 15;
+    }
+
+    buffer[0] = token;
+
+    if (nr_literals >= 15) {
+        size += rec_encode_length(&buffer[size], nr_literals - 15);
+    }
+
+    memcpy(&buffer[size], literals, nr_literals);
+    size += nr_literals;
+
+    if (distance != 0) {
+        buffer[size] = distance;
+        buffer[size + 1] = distance >> 8;
+        size += 2;
+
+        if (length >= 15) {
+            size += rec_encode_length(&buffer[size], length - 15);
+        }
+    }
+
+    return size;
+}
+
+/*
+ * Insert the positions up to the given one in the hash chains.
+ *
+ * The chain of a position gives the distance to the previous position
+ * with the same hash, or 0 if there is none within reach.
+ */
+static void
+rec_insert(struct rec *rec, size_t *next, size_t pos, size_t end)
+{
+    while ((*next <= pos) && ((*next + REC_MIN_MATCH) <= end)) {
+        int32_t candidate;
+        uint32_t hash;
+        size_t distance;
+
+        hash = rec_hash(&rec->history[*next]);
+        candidate = rec->hash_table[hash];
+        rec->hash_table[hash] = *next;
+        distance = (candidate < 0) ? 0 : (*next - candidate);
+        rec->chains[*next] = (distance > REC_MAX_DISTANCE) ? 0 : distance;
+        (*next)++;
+    }
+}
+
+/*
+ * Find the longest match for the bytes at the given position, and return
+ * its length.
+ */
+static size_t
+rec_find_match(const struct rec *rec, size_t pos, size_t end,
+               size_t *distance)
+{
+    const uint8_t *history = rec->history;
+    size_t candidate, length = 0;
+
+    candidate = pos;
+    *distance = 0;
+
+    for (unsigned int i = 0; i < REC_MAX_CHAIN_LENGTH; i++) {
+        size_t match_length;
+
+        if (rec->chains[candidate] == 0) {
+            break;
+        }
+
+        candidate -= rec->chains[candidate];
+
+        if ((pos - candidate) > REC_MAX_DISTANCE) {
+            break;
+        }
+
+        match_length = 0;
+
+        while (((pos + match_length) < end)
+               && (history[candidate + match_length]
+                   == history[pos + match_length])) {
+            match_length++;
+        }
+
+        if (match_length > length) {
+            length = match_length;
+            *distance = pos - candidate;
+        }
+    }
+
+    return length;
+}
+
+/*
+ * Compress the bytes of the history from start to end, using the bytes
+ * before start as the dictionary.
+ *
+ * A match is deferred by one byte if the next position has a longer
+ * match.
+ */
+static size_t
+rec_compress(struct rec *rec, size_t start, size_t end, uint8_t *buffer)
+{
+    size_t pos, anchor, next, size = 0;
+
+    assert(start <= end);
+
+    pos = start;
+    anchor = start;
+    next = start;
+
+    while ((pos + REC_MIN_MATCH) <= end) {
+        size_t length, distance, next_length, next_distance;
+
+        rec_insert(rec, &next, pos, end);
+        length = rec_find_match(rec, pos, end, &distance);
+
+        if (length < REC_MIN_MATCH) {
+            pos++;
+            continue;
+        }
+
+        rec_insert(rec, &next, pos + 1, end);
+        next_length = rec_find_match(rec, pos + 1, end, &next_distance);
+
+        if (next_length > (length + 1)) {
+            pos++;
+            length = next_length;
+            distance = next_distance;
+        }
+
+        size += rec_encode_sequence(&buffer[size], &rec->history[anchor],
+                                    pos - anchor, distance, length);
+        pos += length;
+        anchor = pos;
+        rec_insert(rec, &next, pos - 1, end);
+    }
+
+    size += rec_encode_sequence(&buffer[size], &rec->history[anchor],
+                                end - anchor, 0, 0);
+
+    return size;
+}
+
+static bool
+rec_decode_length(const uint8_t *buffer, size_t size, size_t *index,
+                  size_t *length)
+{
+    for (;;) {
+        uint8_t byte;
+
+        if (*index >= size) {
+            return false;
+        }
+
+        byte = buffer[*index];
+        (*index)++;
+        *length += byte;
+
+        if (byte != 255) {
+            return true;
+        }
+    }
+}
+
+/*
+ * Decompress a frame at the end of the history, and return its size.
+ */
+static bool
+rec_decompress(uint8_t *history, size_t history_size,
+               const uint8_t *buffer, size_t size, size_t *frame_size)
+{
+    size_t pos, end, index = 0;
+
+    pos = history_size;
+    end = history_size + REC_FRAME_SIZE;
+
+    for (;;) {
+        size_t nr_literals, length, distance;
+        uint8_t token;
+
+        if (index >= size) {
+            return false;
+        }
+
+        token = buffer[index];
+        index++;
+        nr_literals = token >> 4;
+
+        if ((nr_literals == 15)
+            && !rec_decode_length(buffer, size, &index, &nr_literals)) {
+            return false;
+        }
+
+        if ((nr_literals > (size - index)) || (nr_literals > (end - pos))) {
+            return false;
+        }
+
+        memcpy(&history[pos], &buffer[index], nr_literals);
+        index += nr_literals;
+        pos += nr_literals;
+
+        if (index == size) {
+            *frame_size = pos - history_size;
+            return true;
+        }
+
+        if ((size - index) < 2) {
+            return false;
+        }
+
+        distance = buffer[index] | ((size_t)buffer[index + 1] << 8);
+        index += 2;
+        length = (token & 0xf) + REC_MIN_MATCH;
+
+        if (((token & 0xf) == 15)
+            && !rec_decode_length(buffer, size, &index, &length)) {
+            return false;
+        }
+
+        if ((distance == 0) || (distance > pos) || (length > (end - pos))) {
+            return false;
+        }
+
+        /*
+         * Matches may overlap the bytes they produce, e.g. runs.
+         */
+        for (size_t i = 0; i < length; i++) {
+            history[pos] = history[pos - distance];
+            pos++;
+        }
+    }
+}
+
+/*
+ * Prepare the history for a new frame.
+ *
+ * A keyframe starts with an empty history. Otherwise, the history is
+ * reduced if another frame may not fit.
+ */
+static size_t
+rec_prepare_history(uint8_t *history, size_t history_size, bool keyframe)
+{
+    if (keyframe) {
+        return 0;
+    }
+
+    if (history_size > (REC_HISTORY_SIZE - REC_FRAME_SIZE)) {
+        memmove(history, &history[history_size - REC_WINDOW_SIZE],
+                REC_WINDOW_SIZE);
+        history_size = REC_WINDOW_SIZE;
+    }
+
+    return history_size;
+}
+
+static void
+rec_reset_hash_table(struct rec *rec)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(rec->hash_table); i++) {
+        rec->hash_table[i] = -1;
+    }
+}
+
+static void
+rec_output(struct rec *rec, const void *buffer, size_t size)
+{
+    assert(rec);
+
+    if (rec->failed) {
+        return;
+    }
+
+    if (fwrite(buffer, 1, size, rec->file) != size) {
+        rec->failed = true;
+        return;
+    }
+
+    rec->offset += size;
+    rec->stats.nr_file_bytes += size;
+}
+
+/*
+ * Start the current frame over, possibly as a keyframe.
+ */
+static void
+rec_start_frame(struct rec *rec, bool keyframe)
+{
+    size_t history_size;
+
+    assert(rec);
+
+    history_size = rec_prepare_history(rec->history, rec->history_size,
+                                       keyframe);
+
+    if (history_size != rec->history_size) {
+        rec_reset_hash_table(rec);
+    }
+
+    rec->history_size = history_size;
+    rec->frame_size = 0;
+    rec->overflow = false;
+}
+
+static void
+rec_append(struct rec *rec, const void *buffer, size_t size)
+{
+    assert(rec);
+
+    if (rec->overflow || (size > (REC_FRAME_SIZE - rec->frame_size))) {
+        rec->overflow = true;
+        return;
+    }
+
+    memcpy(&rec->history[rec->history_size + rec->frame_size], buffer, size);
+    rec->frame_size += size;
+}
+
+static void
+rec_write_keyframe(const void *buffer, size_t size, void *arg)
+{
+    rec_append(arg, buffer, size);
+}
+
+/*
+ * Fill the index entries of the periods starting before the given time.
+ */
+static void
+rec_update_index(struct rec *rec, uint32_t time)
+{
+    assert(rec);
+
+    while ((rec->index_size < ARRAY_SIZE(rec->index))
+           && ((rec->index_size * REC_INDEX_PERIOD) < time)) {
+        rec->index[rec->index_size] = rec->keyframe_offset;
+        rec->index_size++;
+    }
+}
+
+void
+rec_init(struct rec *rec, FILE *file, eetg_write_fn write_fn, void *arg)
+{
+    assert(rec);
+    assert(file);
+
+    rec->file = file;
+    rec->write_fn = write_fn;
+    rec->write_fn_arg = arg;
+    rec->history_size = 0;
+    rec->offset = 0;
+    rec->started = false;
+    rec->failed = false;
+    rec->last_time = 0;
+    rec->keyframe_time = 0;
+    rec->keyframe_offset = 0;
+    rec->index_size = 0;
+
+    memset(&rec->stats, 0, sizeof(rec->stats));
+
+    rec_reset_hash_table(rec);
+    rec_start_frame(rec, true);
+}
+
+static void
+rec_write_header(struct rec *rec, const struct eetg_world *world)
+{
+    uint8_t header[REC_HEADER_SIZE];
+
+    assert(rec);
+    assert(world);
+
+    memcpy(header, REC_MAGIC, 4);
+    header[4] = REC_VERSION;
+    rec_write16(&header[5], eetg_world_get_viewport_nr_rows(world));
+    rec_write16(&header[7], eetg_world_get_viewport_nr_columns(world));
+    rec_output(rec, header, sizeof(header));
+}
+
+void
+rec_write(const void *buffer, size_t size, void *arg)
+{
+    struct rec *rec = arg;
+
+    assert(rec);
+
+    rec_append(rec, buffer, size);
+
+    if (rec->write_fn) {
+        rec->write_fn(buffer, size, rec->write_fn_arg);
+    }
+}
+
+void
+rec_end_frame(struct rec *rec, const struct eetg_world *world, uint32_t time)
+{
+    size_t header_size, size;
+    uint32_t elapsed;
+    bool keyframe;
+
+    assert(rec);
+    assert(world);
+    assert(!rec->started || (time >= rec->last_time));
+
+    elapsed = time - rec->keyframe_time;
+    keyframe = !rec->started
+               || rec->overflow
+               || (elapsed >= REC_MAX_KEYFRAME_INTERVAL)
+               || (eetg_world_is_synced(world)
+                   && (elapsed >= REC_KEYFRAME_INTERVAL));
+
+    /*
+     * A keyframe replaces the bytes of the frame, and leaves the terminal
+     * in the same state.
+     */
+    if (keyframe) {
+        rec_start_frame(rec, true);
+        rec_reset_hash_table(rec);
+        eetg_world_write_keyframe(world, rec_write_keyframe, rec);
+
+        /*
+         * Keyframes are much smaller than the maximum frame size.
+         */
+        assert(!rec->overflow);
+    } else if (rec->frame_size == 0) {
+        return;
+    }
+
+    if (!rec->started) {
+        rec_write_header(rec, world);
+        rec->keyframe_offset = rec->offset;
+        rec->started = true;
+    }
+
+    rec_update_index(rec, time);
+
+    if (keyframe) {
+        header_size = rec_encode_varint(rec->record,
+                                        (time << 1) | REC_TYPE_KEYFRAME);
+        rec->keyframe_time = time;
+        rec->keyframe_offset = rec->offset;
+        rec->stats.nr_keyframes++;
+    } else {
+        header_size = rec_encode_varint(rec->record,
+                                        ((time - rec->last_time) << 1)
+                                        | REC_TYPE_DELTA);
+    }
+
+    /*
+     * The compressed data are stored at the end of the record buffer, so
+     * that the header, which depends on their size, is prepended without
+     * moving them.
+     */
+    size = rec_compress(rec, rec->history_size,
+                        rec->history_size + rec->frame_size,
+                        &rec->record[32]);
+    assert((size + 32) <= sizeof(rec->record));
+
+    header_size += rec_encode_varint(&rec->record[header_size], size);
+    assert(header_size <= 32);
+
+    memmove(&rec->record[header_size], &rec->record[32], size);
+    rec_output(rec, rec->record, header_size + size);
+
+    rec->stats.nr_frames++;
+    rec->stats.nr_raw_bytes += rec->frame_size;
+    rec->last_time = time;
+
+    rec->history_size += rec->frame_size;
+    rec_start_frame(rec, false);
+}
+
+bool
+rec_close(struct rec *rec)
+{
+    uint8_t buffer[REC_TRAILER_SIZE];
+    uint32_t index_offset;
+
+    assert(rec);
+
+    if (rec->started) {
+        rec_update_index(rec, rec->last_time + 1);
+
+        index_offset = rec->offset;
+
+        for (size_t i = 0; i < rec->index_size; i++) {
+            rec_write32(buffer, rec->index[i]);
+            rec_output(rec, buffer, 4);
+        }
+
+        rec_write32(&buffer[0], index_offset);
+        rec_write32(&buffer[4], rec->index_size);
+        memcpy(&buffer[8], REC_INDEX_MAGIC, 4);
+        rec_output(rec, buffer, sizeof(buffer));
+    }
+
+    if (fflush(rec->file) != 0) {
+        rec->failed = true;
+    }
+
+    return !rec->failed;
+}
+
+void
+rec_get_stats(const struct rec *rec, struct rec_stats *stats)
+{
+    assert(rec);
+    assert(stats);
+
+    *stats = rec->stats;
+}
+
+static bool
+rec_player_set_offset(struct rec_player *player, uint32_t offset)
+{
+    assert(player);
+
+    if (fseek(player->file, offset, SEEK_SET) != 0) {
+        return false;
+    }
+
+    player->offset = offset;
+    return true;
+}
+
+/*
+ * Read the header of the next record.
+ */
+static bool
+rec_player_read_header(struct rec_player *player, bool *keyframe,
+                       uint32_t *time, uint32_t *size)
+{
+    uint32_t value;
+
+    assert(player);
+
+    if ((player->offset >= player->end)
+        || !rec_read_varint(player->file, &value, &player->offset)
+        || !rec_read_varint(player->file, size, &player->offset)) {
+        return false;
+    }
+
+    *keyframe = ((value & 1) == REC_TYPE_KEYFRAME);
+    *time = value >> 1;
+
+    return *size <= sizeof(player->record);
+}
+
+/*
+ * Seek by reading the headers of all records, for recordings without
+ * an index.
+ */
+static bool
+rec_player_scan(struct rec_player *player, uint32_t time)
+{
+    uint32_t keyframe_offset, current_time;
+
+    assert(player);
+
+    if (!rec_player_set_offset(player, REC_HEADER_SIZE)) {
+        return false;
+    }
+
+    keyframe_offset = REC_HEADER_SIZE;
+    current_time = 0;
+
+    for (;;) {
+        uint32_t offset, frame_time, size;
+        bool keyframe;
+
+        offset = player->offset;
+
+        if (!rec_player_read_header(player, &keyframe, &frame_time, &size)) {
+            break;
+        }
+
+        current_time = keyframe ? frame_time : (current_time + frame_time);
+
+        if (current_time > time) {
+            break;
+        }
+
+        if (keyframe) {
+            keyframe_offset = offset;
+        }
+
+        if (!rec_player_set_offset(player, player->offset + size)) {
+            return false;
+        }
+    }
+
+    return rec_player_set_offset(player, keyframe_offset);
+}
+
+bool
+rec_player_init(struct rec_player *player, FILE *file)
+{
+    uint8_t header[REC_HEADER_SIZE], trailer[REC_TRAILER_SIZE];
+    long file_size;
+
+    assert(player);
+    assert(file);
+
+    player->file = file;
+    player->history_size = 0;
+    player->time = 0;
+    player->end = UINT32_MAX;
+    player->index_offset = 0;
+    player->index_size = 0;
+
+    if ((fread(header, 1, sizeof(header), file) != sizeof(header))
+        || (memcmp(header, REC_MAGIC, 4) != 0)
+        || (header[4] != REC_VERSION)) {
+        return false;
+    }
+
+    player->nr_rows = rec_read16(&header[5]);
+    player->nr_columns = rec_read16(&header[7]);
+
+    if ((player->nr_rows == 0) || (player->nr_columns == 0)) {
+        return false;
+    }
+
+    /*
+     * Recordings interrupted before the index was written are played
+     * until their last complete record.
+     */
+    if ((fseek(file, -REC_TRAILER_SIZE, SEEK_END) == 0)
+        && ((file_size = ftell(file)) != -1)
+        && (fread(trailer, 1, sizeof(trailer), file) == sizeof(trailer))
+        && (memcmp(&trailer[8], REC_INDEX_MAGIC, 4) == 0)) {
+        player->index_offset = rec_read32(&trailer[0]);
+        player->index_size = rec_read32(&trailer[4]);
+
+        if (((uint64_t)player->index_offset + (player->index_size * 4ULL))
+            != (uint64_t)file_size) {
+            return false;
+        }
+
+        player->end = player->index_offset;
+    }
+
+    return rec_player_set_offset(player, REC_HEADER_SIZE);
+}
+
+int
+rec_player_get_nr_columns(const struct rec_player *player)
+{
+    assert(player);
+
+    return player->nr_columns;
+}
+
+int
+rec_player_get_nr_rows(const struct rec_player *player)
+{
+    assert(player);
+
+    return player->nr_rows;
+}
+
+bool
+rec_player_read_frame(struct rec_player *player, struct rec_frame *frame)
+{
+    uint32_t time, size;
+    size_t frame_size;
+    bool keyframe;
+
+    assert(player);
+    assert(frame);
+
+    if (!rec_player_read_header(player, &keyframe, &time, &size)
+        || (fread(player->record, 1, size, player->file) != size)) {
+        return false;
+    }
+
+    player->offset += size;
+
+    player->history_size = rec_prepare_history(player->history,
+                                               player->history_size,
+                                               keyframe);
+
+    if (!rec_decompress(player->history, player->history_size,
+                        player->record, size, &frame_size)) {
+        return false;
+    }
+
+    player->time = keyframe ? time : (player->time + time);
+
+    frame->data = &player->history[player->history_size];
+    frame->size = frame_size;
+    frame->time = player->time;
+    frame->keyframe = keyframe;
+
+    player->history_size += frame_size;
+
+    return true;
+}
+
+bool
+rec_player_seek(struct rec_player *player, uint32_t time)
+{
+    uint8_t buffer[4];
+    uint32_t slot;
+
+    assert(player);
+
+    if (player->index_size == 0) {
+        return rec_player_scan(player, time);
+    }
+
+    slot = time / REC_INDEX_PERIOD;
+
+    if (slot >= player->index_size) {
+        slot = player->index_size - 1;
+    }
+
+    if ((fseek(player->file, player->index_offset + (slot * 4), SEEK_SET)
+         != 0)
+        || (fread(buffer, 1, sizeof(buffer), player->file)
+            != sizeof(buffer))) {
+        return false;
+    }
+
+    return rec_player_set_offset(player, rec_read32(buffer));
+}
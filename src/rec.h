@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2024 Richard Braun.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS” AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE
+ * FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY
+ * DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *
+ * Session recording.
+ *
+ * A recorder is a write backend recording the bytes of each frame of a
+ * world into a file, and forwarding them to another backend. Frames are
+ * either delta frames, i.e. the bytes the world emitted, or keyframes,
+ * which display the whole screen from any terminal state. Sync frames,
+ * which are full repaints, are recorded as keyframes, no more often than
+ * every REC_KEYFRAME_INTERVAL, so that they don't cost more than they
+ * would as delta frames.
+ *
+ * Frames are compressed with a byte-oriented LZ77 scheme, using the
+ * frames since the last keyframe as the dictionary, which captures both
+ * runs of characters and content repeated from one frame to another.
+ * Since the dictionary is reset on keyframes, decoding may start at any
+ * keyframe.
+ *
+ * The file ends with an index giving, for each REC_INDEX_PERIOD, the
+ * offset of the last keyframe at or before the start of that period, so
+ * that the player seeks to any time with a single lookup, and decodes at
+ * most a keyframe interval and an index period of frames. A recording
+ * interrupted before the index is written can still be played, and is
+ * scanned to seek.
+ *
+ * Times are in milliseconds since the start of the recording.
+ */
+
+#ifndef REC_H
+#define REC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "eetg.h"
+
+/*
+ * Maximum size of a frame, in bytes.
+ *
+ * A frame which doesn't fit is recorded as a keyframe.
+ */
+#define REC_FRAME_SIZE              32768
+
+/*
+ * Size of the dictionary, including the frame being compressed.
+ *
+ * Once there is no room for another frame, the dictionary is reduced
+ * to its last REC_WINDOW_SIZE bytes.
+ */
+#define REC_WINDOW_SIZE             32768
+#define REC_HISTORY_SIZE            (REC_WINDOW_SIZE + (REC_FRAME_SIZE * 2))
+
+/*
+ * Maximum size of a compressed frame, including its header.
+ */
+#define REC_RECORD_SIZE             (REC_FRAME_SIZE + (REC_FRAME_SIZE / 255) \
+                                     + 32)
+
+#define REC_HASH_TABLE_SIZE         4096
+
+#define REC_KEYFRAME_INTERVAL       10000
+#define REC_MAX_KEYFRAME_INTERVAL   30000
+
+/*
+ * Index period, and maximum number of index entries, i.e. 12 hours.
+ * Seeking beyond that duration decodes from the last indexed keyframe.
+ */
+#define REC_INDEX_PERIOD            1000
+#define REC_MAX_INDEX_SIZE          (12 * 3600)
+
+struct rec_stats {
+    unsigned long nr_frames;
+    unsigned long nr_keyframes;
+    uint64_t nr_raw_bytes;
+    uint64_t nr_file_bytes;
+};
+
+struct rec {
+    FILE *file;
+    eetg_write_fn write_fn;
+    void *write_fn_arg;
+    uint8_t history[REC_HISTORY_SIZE];
+    size_t history_size;
+    size_t frame_size;
+    bool overflow;
+    int32_t hash_table[REC_HASH_TABLE_SIZE];
+    uint16_t chains[REC_HISTORY_SIZE];
+    uint8_t record[REC_RECORD_SIZE];
+    uint32_t offset;
+    bool started;
+    bool failed;
+    uint32_t last_time;
+    uint32_t keyframe_time;
+    uint32_t keyframe_offset;
+    uint32_t index[REC_MAX_INDEX_SIZE];
+    size_t index_size;
+    struct rec_stats stats;
+};
+
+struct rec_frame {
+    const void *data;
+    size_t size;
+    uint32_t time;
+    bool keyframe;
+};
+
+struct rec_player {
+    FILE *file;
+    uint8_t history[REC_HISTORY_SIZE];
+    size_t history_size;
+    uint8_t record[REC_RECORD_SIZE];
+    uint32_t offset;
+    uint32_t end;
+    uint32_t time;
+    uint32_t index_offset;
+    uint32_t index_size;
+    int nr_columns;
+    int nr_rows;
+};
+
+/*
+ * Initialize a recorder writing to the given file.
+ *
+ * If write_fn is NULL, bytes aren't forwarded. The header is written with
+ * the first frame, with the size of the viewport of its world.
+ */
+void rec_init(struct rec *rec, FILE *file, eetg_write_fn write_fn, void *arg);
+
+/*
+ * Write function, suitable for use as an engine write backend, with the
+ * recorder as its argument.
+ */
+void rec_write(const void *buffer, size_t size, void *arg);
+
+/*
+ * End a frame of the given world, and record it with the given time.
+ *
+ * The world must be the one writing to the recorder, and times must not
+ * decrease.
+ */
+void rec_end_frame(struct rec *rec, const struct eetg_world *world,
+                   uint32_t time);
+
+/*
+ * Write the index, and flush the file.
+ *
+ * A recording without frames is left empty. Return false if the
+ * recording couldn't be entirely written.
+ */
+bool rec_close(struct rec *rec);
+
+void rec_get_stats(const struct rec *rec, struct rec_stats *stats);
+
+/*
+ * Initialize a player reading the given recording.
+ *
+ * The player starts at the beginning of the recording. Return false if
+ * the file isn't a valid recording.
+ */
+bool rec_player_init(struct rec_player *player, FILE *file);
+
+/*
+ * Return the size of the screen of a recording.
+ */
+int rec_player_get_nr_columns(const struct rec_player *player);
+int rec_player_get_nr_rows(const struct rec_player *player);
+
+/*
+ * Read the next frame.
+ *
+ * The frame data remain valid until the next call. Return false at the
+ * end of the recording, or if it's invalid.
+ */
+bool rec_player_read_frame(struct rec_player *player,
+                           struct rec_frame *frame);
+
+/*
+ * Move to a keyframe at or before the given time.
+ *
+ * Writing the frames read from there, up to the given time, displays the
+ * recording as it was at that time. Return false on error.
+ */
+bool rec_player_seek(struct rec_player *player, uint32_t time);
+
+#endif /* REC_H */
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2024 Richard Braun.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS” AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE
+ * FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY
+ * DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *
+ * Software model of a serial link.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "eetg.h"
+#include "uart.h"
+
+/*
+ * Number of bits per byte on the wire, with 8N1 framing.
+ */
+#define UART_BITS_PER_BYTE 10
+
+#define UART_NS_PER_S   1000000000ULL
+#define UART_NS_PER_US  1000ULL
+
+static uint64_t
+uart_get_time(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * UART_NS_PER_S) + ts.tv_nsec;
+}
+
+static void
+uart_sleep(uint64_t duration)
+{
+    struct timespec ts;
+
+    ts.tv_sec = duration / UART_NS_PER_S;
+    ts.tv_nsec = duration % UART_NS_PER_S;
+
+    nanosleep(&ts, NULL);
+}
+
+static size_t
+uart_get_level(const struct uart *uart, uint64_t now)
+{
+    uint64_t level;
+
+    assert(uart);
+
+    if (uart->tx_end <= now) {
+        return 0;
+    }
+
+    level = (uart->tx_end - now + uart->byte_time - 1) / uart->byte_time;
+
+    return (level > uart->fifo_size) ? uart->fifo_size : level;
+}
+
+static size_t
+uart_get_room_at(const struct uart *uart, uint64_t now)
+{
+    return uart->fifo_size - uart_get_level(uart, now);
+}
+
+static void
+uart_queue(struct uart *uart, uint64_t now, const void *buffer, size_t size)
+{
+    assert(uart);
+
+    if (uart->tx_end < now) {
+        uart->tx_end = now;
+    }
+
+    uart->tx_end += size * uart->byte_time;
+    uart->stats.nr_bytes += size;
+    uart->stats.frame_size += size;
+
+    uart->write_fn(buffer, size, uart->write_fn_arg);
+}
+
+void
+uart_init(struct uart *uart, unsigned long baud_rate, size_t fifo_size,
+          int mode, unsigned long frame_period,
+          eetg_write_fn write_fn, void *arg)
+{
+    assert(uart);
+    assert(baud_rate != 0);
+    assert(fifo_size != 0);
+    assert((mode == UART_MODE_BLOCKING) || (mode == UART_MODE_BACKPRESSURE));
+    assert(write_fn);
+
+    uart->write_fn = write_fn;
+    uart->write_fn_arg = arg;
+    uart->byte_time = (UART_NS_PER_S * UART_BITS_PER_BYTE) / baud_rate;
+    uart->frame_period = frame_period * UART_NS_PER_US;
+    uart->start_time = uart_get_time();
+    uart->tx_end = uart->start_time;
+    uart->fifo_size = fifo_size;
+    uart->mode = mode;
+
+    uart->stats.nr_frames = 0;
+    uart->stats.nr_missed_deadlines = 0;
+    uart->stats.nr_overruns = 0;
+    uart->stats.nr_bytes = 0;
+    uart->stats.frame_size = 0;
+    uart->stats.frame_tx_time = 0;
+    uart->stats.max_frame_tx_time = 0;
+    uart->stats.tx_time = 0;
+    uart->stats.elapsed = 0;
+}
+
+void
+uart_write(const void *buffer, size_t size, void *arg)
+{
+    struct uart *uart = arg;
+    const char *ptr = buffer;
+
+    assert(uart);
+
+    if (uart->mode == UART_MODE_BACKPRESSURE) {
+        uint64_t now;
+        size_t room;
+
+        now = uart_get_time();
+        room = uart_get_room_at(uart, now);
+
+        if (size > room) {
+            uart->stats.nr_overruns += size - room;
+        }
+
+        uart_queue(uart, now, buffer, size);
+        return;
+    }
+
+    while (size != 0) {
+        uint64_t now;
+        size_t room;
+
+        now = uart_get_time();
+        room = uart_get_room_at(uart, now);
+
+        if (room == 0) {
+            size_t needed;
+
+            needed = (size < uart->fifo_size) ? size : uart->fifo_size;
+            uart_sleep(uart->tx_end - (uart->fifo_size - needed)
+                       * uart->byte_time - now);
+            continue;
+        }
+
+        if (room > size) {
+            room = size;
+        }
+
+        uart_queue(uart, now, ptr, room);
+
+        ptr += room;
+        size -= room;
+    }
+}
+
+size_t
+uart_get_room(struct uart *uart)
+{
+    return uart_get_room_at(uart, uart_get_time());
+}
+
+void
+uart_start_frame(struct uart *uart)
+{
+    assert(uart);
+
+    uart->stats.frame_size = 0;
+}
+
+void
+uart_end_frame(struct uart *uart)
+{
+    uint64_t now, end, tx_time;
+
+    assert(uart);
+
+    now = uart_get_time();
+    end = (uart->tx_end > now) ? uart->tx_end : now;
+
+    tx_time = (uart->stats.frame_size * uart->byte_time) / UART_NS_PER_US;
+    uart->stats.frame_tx_time = tx_time;
+    uart->stats.tx_time += tx_time;
+
+    if (tx_time > uart->stats.max_frame_tx_time) {
+        uart->stats.max_frame_tx_time = tx_time;
+    }
+
+    /*
+     * Bytes still queued from previous frames delay a frame, but don't
+     * make it miss its deadline, so that missed deadlines and the frame
+     * rate agree.
+     */
+    if ((uart->stats.frame_size * uart->byte_time) > uart->frame_period) {
+        uart->stats.nr_missed_deadlines++;
+    }
+
+    uart->stats.nr_frames++;
+    uart->stats.elapsed = (end - uart->start_time) / UART_NS_PER_US;
+}
+
+void
+uart_get_stats(const struct uart *uart, struct uart_stats *stats)
+{
+    assert(uart);
+    assert(stats);
+
+    *stats = uart->stats;
+}
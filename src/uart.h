@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2024 Richard Braun.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS” AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE
+ * FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY
+ * DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *
+ * Software model of a serial link.
+ *
+ * A UART is a write backend forwarding bytes to another backend, at the
+ * speed of a serial link with the given baud rate, using 8N1 framing.
+ * Bytes are queued in a transmit FIFO of fixed depth. In blocking mode,
+ * writes wait for FIFO space, like a blocking write to a serial device.
+ * In back-pressure mode, writes never wait, and the caller is expected
+ * to limit its output to the room left in the FIFO. Bytes written in
+ * excess are counted as overruns.
+ */
+
+#ifndef UART_H
+#define UART_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "eetg.h"
+
+#define UART_MODE_BLOCKING      0
+#define UART_MODE_BACKPRESSURE  1
+
+struct uart_stats {
+    unsigned long nr_frames;
+    unsigned long nr_missed_deadlines;
+    unsigned long nr_overruns;
+    uint64_t nr_bytes;
+    uint64_t frame_size;
+    uint64_t frame_tx_time;     /* us */
+    uint64_t max_frame_tx_time; /* us */
+    uint64_t tx_time;           /* us */
+    uint64_t elapsed;           /* us */
+};
+
+struct uart {
+    eetg_write_fn write_fn;
+    void *write_fn_arg;
+    uint64_t byte_time;         /* ns */
+    uint64_t frame_period;      /* ns */
+    uint64_t start_time;
+    uint64_t tx_end;
+    size_t fifo_size;
+    int mode;
+    struct uart_stats stats;
+};
+
+/*
+ * Initialize a UART.
+ *
+ * The frame period, in microseconds, is used to detect missed deadlines,
+ * i.e. frames that the link can't transmit within one period.
+ */
+void uart_init(struct uart *uart, unsigned long baud_rate, size_t fifo_size,
+               int mode, unsigned long frame_period,
+               eetg_write_fn write_fn, void *arg);
+
+/*
+ * Write function, suitable for use as an engine write backend, with the
+ * UART as its argument.
+ */
+void uart_write(const void *buffer, size_t size, void *arg);
+
+/*
+ * Return the number of bytes that can currently be written without
+ * blocking or overrunning the FIFO.
+ */
+size_t uart_get_room(struct uart *uart);
+
+/*
+ * Delimit frames for the purpose of statistics.
+ */
+void uart_start_frame(struct uart *uart);
+void uart_end_frame(struct uart *uart);
+
+void uart_get_stats(const struct uart *uart, struct uart_stats *stats);
+
+#endif /* UART_H */
@@ -0,0 +1,548 @@
+/*
+ * Copyright (c) 2024 Richard Braun.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS” AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE
+ * FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY
+ * DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *
+ * Terminal model.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "eetg.h"
+#include "macros.h"
+#include "vt.h"
+
+#define VT_STATE_GROUND 0
+#define VT_STATE_ESC    1
+#define VT_STATE_CSI    2
+
+#define VT_DEFAULT_COLOR EETG_COLOR_WHITE
+
+static const char *vt_class_names[VT_NR_CLASSES] = {
+    [VT_CLASS_TEXT] = "text",
+    [VT_CLASS_CURSOR] = "cursor",
+    [VT_CLASS_COLOR] = "color",
+    [VT_CLASS_ERASE] = "erase",
+    [VT_CLASS_SCROLL] = "scroll",
+    [VT_CLASS_SHIFT] = "shift",
+    [VT_CLASS_MODE] = "mode",
+    [VT_CLASS_OTHER] = "other",
+};
+
+static void
+vt_cell_clear(struct vt_cell *cell)
+{
+    cell->c = ' ';
+    cell->color = VT_DEFAULT_COLOR;
+}
+
+static void
+vt_clear_range(struct vt *vt, int row, int start, int end)
+{
+    for (int column = start; column < end; column++) {
+        vt_cell_clear(&vt->screen->cells[row][column]);
+    }
+}
+
+static void
+vt_clear_rows(struct vt *vt, int start, int end)
+{
+    for (int row = start; row < end; row++) {
+        vt_clear_range(vt, row, 0, vt->nr_columns);
+    }
+}
+
+static void
+vt_reset(struct vt *vt)
+{
+    vt->screen = &vt->screens[0];
+    vt_clear_rows(vt, 0, vt->nr_rows);
+    vt->row = 0;
+    vt->column = 0;
+    vt->wrap_pending = false;
+    vt->color = VT_DEFAULT_COLOR;
+    vt->top = 0;
+    vt->bottom = vt->nr_rows - 1;
+}
+
+void
+vt_set_size(struct vt *vt, int nr_columns, int nr_rows)
+{
+    assert(vt);
+    assert(nr_columns > 0);
+    assert(nr_columns <= EETG_MAX_COLUMNS);
+    assert(nr_rows > 0);
+    assert(nr_rows <= EETG_MAX_ROWS);
+
+    vt->nr_columns = nr_columns;
+    vt->nr_rows = nr_rows;
+    vt->screen = &vt->screens[1];
+    vt_clear_rows(vt, 0, vt->nr_rows);
+    vt_reset(vt);
+}
+
+void
+vt_init(struct vt *vt, eetg_write_fn write_fn, void *arg)
+{
+    assert(vt);
+
+    vt->write_fn = write_fn;
+    vt->write_fn_arg = arg;
+    vt->state = VT_STATE_GROUND;
+    vt->seq_size = 0;
+
+    vt_set_size(vt, EETG_COLUMNS, EETG_ROWS);
+
+    vt->stats.nr_frames = 0;
+    vt->stats.nr_mismatches = 0;
+
+    for (size_t i = 0; i < ARRAY_SIZE(vt->stats.nr_bytes); i++) {
+        vt->stats.nr_bytes[i] = 0;
+    }
+}
+
+static int
+vt_get_param(const struct vt *vt, int index, int default_value)
+{
+    if ((index >= vt->nr_params) || (vt->params[index] == 0)) {
+        return default_value;
+    }
+
+    return vt->params[index];
+}
+
+static int
+vt_clamp(int value, int min, int max)
+{
+    if (value < min) {
+        return min;
+    } else if (value > max) {
+        return max;
+    }
+
+    return value;
+}
+
+/*
+ * Scroll the scrolling region, up (positive count) or down (negative
+ * count).
+ */
+static void
+vt_scroll(struct vt *vt, int count)
+{
+    struct vt_cell (*cells)[EETG_MAX_COLUMNS];
+    int height;
+
+    height = vt->bottom - vt->top + 1;
+    cells = vt->screen->cells;
+
+    if (count > 0) {
+        count = vt_clamp(count, 0, height);
+        memmove(&cells[vt->top], &cells[vt->top + count],
+                (height - count) * sizeof(cells[0]));
+        vt_clear_rows(vt, vt->bottom + 1 - count, vt->bottom + 1);
+    } else {
+        count = vt_clamp(-count, 0, height);
+        memmove(&cells[vt->top + count], &cells[vt->top],
+                (height - count) * sizeof(cells[0]));
+        vt_clear_rows(vt, vt->top, vt->top + count);
+    }
+}
+
+static void
+vt_put_char(struct vt *vt, char c)
+{
+    struct vt_cell *cell;
+
+    if (vt->wrap_pending) {
+        vt->wrap_pending = false;
+        vt->column = 0;
+
+        if (vt->row == vt->bottom) {
+            vt_scroll(vt, 1);
+        } else if (vt->row < (vt->nr_rows - 1)) {
+            vt->row++;
+        }
+    }
+
+    cell = &vt->screen->cells[vt->row][vt->column];
+    cell->c = c;
+    cell->color = vt->color;
+
+    if (vt->column == (vt->nr_columns - 1)) {
+        vt->wrap_pending = true;
+    } else {
+        vt->column++;
+    }
+}
+
+/*
+ * Insert (positive count) or delete (negative count) characters at the
+ * cursor position.
+ */
+static void
+vt_shift(struct vt *vt, int count)
+{
+    struct vt_cell *cells;
+    int room;
+
+    cells = vt->screen->cells[vt->row];
+    room = vt->nr_columns - vt->column;
+
+    if (count > 0) {
+        count = vt_clamp(count, 0, room);
+        memmove(&cells[vt->column + count], &cells[vt->column],
+                (room - count) * sizeof(cells[0]));
+        vt_clear_range(vt, vt->row, vt->column, vt->column + count);
+    } else {
+        count = vt_clamp(-count, 0, room);
+        memmove(&cells[vt->column], &cells[vt->column + count],
+                (room - count) * sizeof(cells[0]));
+        vt_clear_range(vt, vt->row, vt->nr_columns - count, vt->nr_columns);
+    }
+}
+
+static void
+vt_set_colors(struct vt *vt)
+{
+    if (vt->nr_params == 0) {
+        vt->color = VT_DEFAULT_COLOR;
+        return;
+    }
+
+    for (int i = 0; i < vt->nr_params; i++) {
+        int param = vt->params[i];
+
+        if ((param == 0) || (param == 39)) {
+            vt->color = VT_DEFAULT_COLOR;
+        } else if ((param >= 30) && (param <= 37)) {
+            vt->color = param - 30;
+        }
+    }
+}
+
+static void
+vt_set_mode(struct vt *vt, bool enabled)
+{
+    for (int i = 0; i < vt->nr_params; i++) {
+        if (vt->params[i] != 1049) {
+            continue;
+        }
+
+        vt->screen = &vt->screens[enabled ? 1 : 0];
+
+        if (enabled) {
+            vt_clear_rows(vt, 0, vt->nr_rows);
+        }
+    }
+}
+
+/*
+ * Execute a control sequence, and return its class.
+ */
+static int
+vt_execute_csi(struct vt *vt, char final)
+{
+    int n;
+
+    if (vt->private) {
+        if ((final == 'h') || (final == 'l')) {
+            vt_set_mode(vt, final == 'h');
+        }
+
+        return VT_CLASS_MODE;
+    }
+
+    switch (final) {
+    case 'H':
+    case 'f':
+        vt->row = vt_clamp(vt_get_param(vt, 0, 1) - 1, 0, vt->nr_rows - 1);
+        vt->column = vt_clamp(vt_get_param(vt, 1, 1) - 1,
+                              0, vt->nr_columns - 1);
+        vt->wrap_pending = false;
+        return VT_CLASS_CURSOR;
+    case 'C':
+        vt->column = vt_clamp(vt->column + vt_get_param(vt, 0, 1),
+                              0, vt->nr_columns - 1);
+        vt->wrap_pending = false;
+        return VT_CLASS_CURSOR;
+    case 'm':
+        vt_set_colors(vt);
+        return VT_CLASS_COLOR;
+    case 'J':
+        n = (vt->nr_params == 0) ? 0 : vt->params[0];
+
+        if (n == 0) {
+            vt_clear_range(vt, vt->row, vt->column, vt->nr_columns);
+            vt_clear_rows(vt, vt->row + 1, vt->nr_rows);
+        } else if (n == 1) {
+            vt_clear_rows(vt, 0, vt->row);
+            vt_clear_range(vt, vt->row, 0, vt->column + 1);
+        } else {
+            vt_clear_rows(vt, 0, vt->nr_rows);
+        }
+
+        return VT_CLASS_ERASE;
+    case 'K':
+        n = (vt->nr_params == 0) ? 0 : vt->params[0];
+
+        if (n == 0) {
+            vt_clear_range(vt, vt->row, vt->column, vt->nr_columns);
+        } else if (n == 1) {
+            vt_clear_range(vt, vt->row, 0, vt->column + 1);
+        } else {
+            vt_clear_range(vt, vt->row, 0, vt->nr_columns);
+        }
+
+        return VT_CLASS_ERASE;
+    case 'r':
+        vt->top = vt_clamp(vt_get_param(vt, 0, 1) - 1, 0, vt->nr_rows - 1);
+        vt->bottom = vt_clamp(vt_get_param(vt, 1, vt->nr_rows) - 1,
+                              0, vt->nr_rows - 1);
+
+        if (vt->top >= vt->bottom) {
+            vt->top = 0;
+            vt->bottom = vt->nr_rows - 1;
+        }
+
+        vt->row = 0;
+        vt->column = 0;
+        vt->wrap_pending = false;
+        return VT_CLASS_SCROLL;
+    case 'S':
+        vt_scroll(vt, vt_get_param(vt, 0, 1));
+        return VT_CLASS_SCROLL;
+    case 'T':
+        vt_scroll(vt, -vt_get_param(vt, 0, 1));
+        return VT_CLASS_SCROLL;
+    case '@':
+        vt_shift(vt, vt_get_param(vt, 0, 1));
+        vt->wrap_pending = false;
+        return VT_CLASS_SHIFT;
+    case 'P':
+        vt_shift(vt, -vt_get_param(vt, 0, 1));
+        vt->wrap_pending = false;
+        return VT_CLASS_SHIFT;
+    default:
+        return VT_CLASS_OTHER;
+    }
+}
+
+static void
+vt_end_sequence(struct vt *vt, int class)
+{
+    vt->stats.nr_bytes[class] += vt->seq_size;
+    vt->seq_size = 0;
+    vt->state = VT_STATE_GROUND;
+}
+
+static void
+vt_process(struct vt *vt, char c)
+{
+    vt->seq_size++;
+
+    switch (vt->state) {
+    case VT_STATE_GROUND:
+        if (c == '\e') {
+            vt->state = VT_STATE_ESC;
+            return;
+        }
+
+        if ((c >= ' ') && (c <= '~')) {
+            vt_put_char(vt, c);
+            vt_end_sequence(vt, VT_CLASS_TEXT);
+        } else {
+            vt_end_sequence(vt, VT_CLASS_OTHER);
+        }
+
+        break;
+    case VT_STATE_ESC:
+        if (c == '[') {
+            vt->state = VT_STATE_CSI;
+            vt->nr_params = 0;
+            vt->private = false;
+        } else if (c == 'c') {
+            vt_reset(vt);
+            vt_end_sequence(vt, VT_CLASS_ERASE);
+        } else {
+            vt_end_sequence(vt, VT_CLASS_OTHER);
+        }
+
+        break;
+    case VT_STATE_CSI:
+        if (c == '?') {
+            vt->private = true;
+        } else if ((c >= '0') && (c <= '9')) {
+            if (vt->nr_params == 0) {
+                vt->params[0] = 0;
+                vt->nr_params = 1;
+            }
+
+            if (vt->nr_params <= VT_MAX_PARAMS) {
+                int *param = &vt->params[vt->nr_params - 1];
+
+                *param = (*param * 10) + (c - '0');
+            }
+        } else if (c == ';') {
+            if (vt->nr_params == 0) {
+                vt->params[0] = 0;
+                vt->nr_params = 1;
+            }
+
+            if (vt->nr_params < VT_MAX_PARAMS) {
+                vt->params[vt->nr_params] = 0;
+            }
+
+            vt->nr_params++;
+        } else if ((c >= '@') && (c <= '~')) {
+            if (vt->nr_params > VT_MAX_PARAMS) {
+                vt->nr_params = VT_MAX_PARAMS;
+            }
+
+            vt_end_sequence(vt, vt_execute_csi(vt, c));
+        }
+
+        break;
+    }
+}
+
+void
+vt_write(const void *buffer, size_t size, void *arg)
+{
+    struct vt *vt = arg;
+    const char *ptr = buffer;
+
+    assert(vt);
+
+    for (size_t i = 0; i < size; i++) {
+        vt_process(vt, ptr[i]);
+    }
+
+    if (vt->write_fn) {
+        vt->write_fn(buffer, size, vt->write_fn_arg);
+    }
+}
+
+static bool
+vt_cell_matches(const struct vt_cell *cell, char c, int color)
+{
+    /*
+     * The color of blank cells isn't visible.
+     */
+    return (cell->c == c) && ((c == ' ') || (cell->color == color));
+}
+
+size_t
+vt_check(struct vt *vt, const struct eetg_output *output)
+{
+    size_t nr_mismatches = 0;
+    bool complete = true;
+
+    assert(vt);
+    assert(output);
+
+    /*
+     * Rows without deferred cells must be displayed as in the view, so
+     * that a changed cell missed by the renderer is detected, even if it
+     * consistently left both the screen and the output unchanged.
+     */
+    for (int row = 0; row < vt->nr_rows; row++) {
+        if (eetg_output_is_row_pending(output, row)) {
+            complete = false;
+            continue;
+        }
+
+        for (int column = 0; column < vt->nr_columns; column++) {
+            int color, view_color;
+            char c, view_c;
+
+            eetg_output_get_cell(output, row, column, &c, &color);
+            eetg_output_get_view_cell(output, row, column,
+                                      &view_c, &view_color);
+
+            if ((c != view_c) || (color != view_color)) {
+                nr_mismatches++;
+            }
+        }
+    }
+
+    /*
+     * The screen is compared with the view if the frame is complete, and
+     * with what the output last displayed otherwise.
+     */
+    for (int row = 0; row < vt->nr_rows; row++) {
+        for (int column = 0; column < vt->nr_columns; column++) {
+            int color;
+            char c;
+
+            if (complete) {
+                eetg_output_get_view_cell(output, row, column, &c, &color);
+            } else {
+                eetg_output_get_cell(output, row, column, &c, &color);
+            }
+
+            if (!vt_cell_matches(&vt->screen->cells[row][column],
+                                 c, color)) {
+                nr_mismatches++;
+            }
+        }
+    }
+
+    vt->stats.nr_frames++;
+
+    if (nr_mismatches != 0) {
+        vt->stats.nr_mismatches++;
+    }
+
+    return nr_mismatches;
+}
+
+void
+vt_get_cell(const struct vt *vt, int row, int column, char *c, int *color)
+{
+    const struct vt_cell *cell;
+
+    assert(vt);
+    assert(row >= 0);
+    assert(row < vt->nr_rows);
+    assert(column >= 0);
+    assert(column < vt->nr_columns);
+    assert(c);
+    assert(color);
+
+    cell = &vt->screen->cells[row][column];
+    *c = cell->c;
+    *color = cell->color;
+}
+
+const char *
+vt_get_class_name(int class)
+{
+    assert(class >= 0);
+    assert(class < VT_NR_CLASSES);
+
+    return vt_class_names[class];
+}
+
+void
+vt_get_stats(const struct vt *vt, struct vt_stats *stats)
+{
+    assert(vt);
+    assert(stats);
+
+    *stats = vt->stats;
+}
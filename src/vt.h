@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2024 Richard Braun.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS” AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE
+ * FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY
+ * DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *
+ * Terminal model.
+ *
+ * A VT is a write backend interpreting the subset of VT100/ANSI sequences
+ * used by the engine, in order to rebuild the content of the screen,
+ * including colors, so that it can be compared with what the engine
+ * believes is displayed. Bytes are counted by sequence class. Bytes may
+ * be forwarded to another write backend.
+ *
+ * As with common terminals, the cursor doesn't wrap when writing to the
+ * last column, until another character is written.
+ */
+
+#ifndef VT_H
+#define VT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "eetg.h"
+
+/*
+ * Sequence classes.
+ */
+#define VT_CLASS_TEXT       0   /* printable characters */
+#define VT_CLASS_CURSOR     1   /* cursor position and movement */
+#define VT_CLASS_COLOR      2   /* graphic rendition */
+#define VT_CLASS_ERASE      3   /* erase in display/line, reset */
+#define VT_CLASS_SCROLL     4   /* scrolling region, scroll up/down */
+#define VT_CLASS_SHIFT      5   /* insert/delete characters */
+#define VT_CLASS_MODE       6   /* private modes */
+#define VT_CLASS_OTHER      7
+#define VT_NR_CLASSES       8
+
+#define VT_MAX_PARAMS 8
+
+struct vt_cell {
+    char c;
+    int8_t color;
+};
+
+struct vt_screen {
+    struct vt_cell cells[EETG_MAX_ROWS][EETG_MAX_COLUMNS];
+};
+
+struct vt_stats {
+    unsigned long nr_frames;
+    unsigned long nr_mismatches;
+    uint64_t nr_bytes[VT_NR_CLASSES];
+};
+
+struct vt {
+    eetg_write_fn write_fn;
+    void *write_fn_arg;
+    struct vt_screen screens[2];
+    struct vt_screen *screen;
+    int nr_columns;
+    int nr_rows;
+    int params[VT_MAX_PARAMS];
+    int nr_params;
+    int state;
+    bool private;
+    size_t seq_size;
+    int row;
+    int column;
+    bool wrap_pending;
+    int color;
+    int top;
+    int bottom;
+    struct vt_stats stats;
+};
+
+/*
+ * Initialize a VT, with a screen of the default size of worlds.
+ *
+ * If write_fn is NULL, bytes aren't forwarded.
+ */
+void vt_init(struct vt *vt, eetg_write_fn write_fn, void *arg);
+
+/*
+ * Change the size of the screen, up to the size limits of viewports.
+ *
+ * The terminal is reset.
+ */
+void vt_set_size(struct vt *vt, int nr_columns, int nr_rows);
+
+/*
+ * Write function, suitable for use as an engine write backend, with the
+ * VT as its argument.
+ */
+void vt_write(const void *buffer, size_t size, void *arg);
+
+/*
+ * Check the screen against the view of the world of an output, and
+ * return the number of mismatches.
+ *
+ * The screen must have the size of the viewport of the world.
+ * This is meant to be called after each frame. The rows of the view
+ * which have no cells deferred by the byte budget must have been
+ * displayed by the output as they are. If no cells were deferred, the
+ * screen must match the view, and otherwise, it must match what the
+ * output last displayed.
+ */
+size_t vt_check(struct vt *vt, const struct eetg_output *output);
+
+/*
+ * Get the content of a cell of the screen.
+ */
+void vt_get_cell(const struct vt *vt, int row, int column,
+                 char *c, int *color);
+
+const char *vt_get_class_name(int class);
+
+void vt_get_stats(const struct vt *vt, struct vt_stats *stats);
+
+#endif /* VT_H */
@@ -0,0 +1,889 @@
+/*
+ * Copyright (c) 2024 Richard Braun.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS” AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE
+ * FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY
+ * DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *
+ * Compact frame protocol.
+ *
+ * Messages:
+ *  - header: "EIW", version, rows, columns, number of colors, palette
+ *  - frame: row bitmask, then for each changed row, the number of runs,
+ *    and the runs
+ *
+ * A run is made of the number of columns skipped, and its length, shifted
+ * left by two bits, with WIRE_RUN_COLOR and WIRE_RUN_REPEAT, all varints,
+ * then, with WIRE_RUN_COLOR, a color index, then the characters.
+ *
+ * Varints are little-endian base 128, with the high bit of each byte set
+ * if another byte follows. Row bitmasks start with the first row in the
+ * least significant bit of the first byte.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "eetg.h"
+#include "macros.h"
+#include "wire.h"
+
+#define WIRE_MAGIC          "EIW"
+#define WIRE_VERSION        1
+
+#define WIRE_RUN_COLOR      0x1
+#define WIRE_RUN_REPEAT     0x2
+#define WIRE_RUN_SHIFT      2
+
+#define WIRE_MAX_VARINT_SIZE 5
+
+/*
+ * Maximum number of unchanged cells included in a run.
+ *
+ * An unchanged cell costs a byte, whereas starting another run costs at
+ * least two.
+ */
+#define WIRE_MAX_GAP        1
+
+/*
+ * Minimum number of identical characters sent as a repeated run.
+ */
+#define WIRE_MIN_REPEAT     4
+
+#define WIRE_CSI "\e["
+
+#define WIRE_BG_COLOR       EETG_COLOR_BLACK
+#define WIRE_FG_COLOR       EETG_COLOR_WHITE
+
+struct wire_run {
+    int column;
+    int length;
+    int color;
+    bool repeat;
+};
+
+/*
+ * Reader of the bytes of a message.
+ *
+ * Reading past the end of the available bytes marks the reader as
+ * truncated, so that incomplete messages can be told from invalid ones.
+ */
+struct wire_reader {
+    const uint8_t *data;
+    size_t size;
+    size_t index;
+    bool truncated;
+};
+
+static bool
+wire_cell_equals(const struct wire_cell *cell1, const struct wire_cell *cell2)
+{
+    return (cell1->c == cell2->c)
+           && ((cell1->c == ' ') || (cell1->color == cell2->color));
+}
+
+static void
+wire_screen_clear(struct wire_screen *screen)
+{
+    assert(screen);
+
+    for (int row = 0; row < EETG_MAX_ROWS; row++) {
+        for (int column = 0; column < EETG_MAX_COLUMNS; column++) {
+            screen->cells[row][column].c = ' ';
+            screen->cells[row][column].color = 0;
+        }
+    }
+}
+
+static size_t
+wire_write_varint(uint8_t *buffer, uint32_t value)
+{
+    size_t size = 0;
+
+    while (value >= 0x80) {
+        buffer[size] = (value & 0x7f) | 0x80;
+        value >>= 7;
+        size++;
+    }
+
+    buffer[size] = value;
+
+    return size + 1;
+}
+
+static void
+wire_reader_init(struct wire_reader *reader, const uint8_t *data, size_t size)
+{
+    assert(reader);
+
+    reader->data = data;
+    reader->size = size;
+    reader->index = 0;
+    reader->truncated = false;
+}
+
+static bool
+wire_reader_read_byte(struct wire_reader *reader, uint8_t *byte)
+{
+    assert(reader);
+    assert(byte);
+
+    if (reader->index == reader->size) {
+        reader->truncated = true;
+        return false;
+    }
+
+    *byte = reader->data[reader->index];
+    reader->index++;
+
+    return true;
+}
+
+static bool
+wire_reader_read_varint(struct wire_reader *reader, uint32_t *value)
+{
+    uint32_t result = 0;
+
+    assert(value);
+
+    for (int i = 0; i < WIRE_MAX_VARINT_SIZE; i++) {
+        uint8_t byte;
+
+        if (!wire_reader_read_byte(reader, &byte)) {
+            return false;
+        }
+
+        result |= (uint32_t)(byte & 0x7f) << (i * 7);
+
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void
+wire_encoder_start_frame(struct wire_encoder *encoder)
+{
+    assert(encoder);
+
+    memset(encoder->frame, 0, encoder->bitmask_size);
+    encoder->frame_size = encoder->bitmask_size;
+    encoder->next_row = 0;
+}
+
+void
+wire_encoder_init(struct wire_encoder *encoder,
+                  int nr_columns, int nr_rows,
+                  eetg_write_fn write_fn, void *arg)
+{
+    assert(encoder);
+    assert(nr_columns > 0);
+    assert(nr_columns <= EETG_MAX_COLUMNS);
+    assert(nr_rows > 0);
+    assert(nr_rows <= EETG_MAX_ROWS);
+    assert(write_fn);
+
+    encoder->write_fn = write_fn;
+    encoder->write_fn_arg = arg;
+    encoder->nr_columns = nr_columns;
+    encoder->nr_rows = nr_rows;
+    encoder->bitmask_size = WIRE_BITMASK_SIZE(nr_rows);
+    encoder->color = 0;
+    encoder->started = false;
+    wire_encoder_start_frame(encoder);
+    encoder->stats.nr_frames = 0;
+    encoder->stats.nr_bytes = 0;
+}
+
+static void
+wire_encoder_write(struct wire_encoder *encoder, const void *buffer,
+                   size_t size)
+{
+    assert(encoder);
+
+    encoder->write_fn(buffer, size, encoder->write_fn_arg);
+    encoder->stats.nr_bytes += size;
+}
+
+static void
+wire_encoder_write_header(struct wire_encoder *encoder)
+{
+    uint8_t header[WIRE_HEADER_SIZE];
+    size_t size;
+
+    assert(encoder);
+
+    memcpy(header, WIRE_MAGIC, 3);
+    header[3] = WIRE_VERSION;
+    size = 4;
+    size += wire_write_varint(&header[size], encoder->nr_rows);
+    size += wire_write_varint(&header[size], encoder->nr_columns);
+    header[size] = WIRE_NR_COLORS;
+    size++;
+
+    /*
+     * Engine colors are ANSI colors.
+     */
+    for (int i = 0; i < WIRE_NR_COLORS; i++) {
+        header[size] = i;
+        size++;
+    }
+
+    assert(size <= sizeof(header));
+    wire_encoder_write(encoder, header, size);
+}
+
+static void
+wire_run_init(struct wire_run *run, int column, int length, int color,
+              bool repeat)
+{
+    assert(run);
+    assert(length > 0);
+
+    run->column = column;
+    run->length = length;
+    run->color = color;
+    run->repeat = repeat;
+}
+
+/*
+ * Split the cells of a run into runs of repeated characters, and runs
+ * of other characters.
+ */
+static int
+wire_encoder_split_run(const struct wire_cell *cells, int start, int end,
+                       int color, struct wire_run *runs)
+{
+    int nr_runs = 0, literal = start;
+
+    assert(start < end);
+
+    for (int i = start; i < end;) {
+        int length = 1;
+
+        while (((i + length) < end) && (cells[i + length].c == cells[i].c)) {
+            length++;
+        }
+
+        if (length >= WIRE_MIN_REPEAT) {
+            if (literal < i) {
+                wire_run_init(&runs[nr_runs], literal, i - literal,
+                              color, false);
+                nr_runs++;
+            }
+
+            wire_run_init(&runs[nr_runs], i, length, color, true);
+            nr_runs++;
+            literal = i + length;
+        }
+
+        i += length;
+    }
+
+    if (literal < end) {
+        wire_run_init(&runs[nr_runs], literal, end - literal, color, false);
+        nr_runs++;
+    }
+
+    return nr_runs;
+}
+
+/*
+ * Build the runs of the given columns of a row, and return their number.
+ *
+ * A run covers changed cells of the same color, or blank, possibly with
+ * a few unchanged cells between them.
+ */
+static int
+wire_encoder_build_runs(const struct wire_cell *cells,
+                        const struct wire_cell *prev_cells,
+                        int column, int last, struct wire_run *runs)
+{
+    int nr_runs = 0;
+
+    for (;;) {
+        int start, end, color;
+
+        while ((column < last)
+               && wire_cell_equals(&cells[column], &prev_cells[column])) {
+            column++;
+        }
+
+        if (column == last) {
+            break;
+        }
+
+        start = column;
+        end = column;
+        color = -1;
+
+        for (int i = start; i < last; i++) {
+            if (cells[i].c != ' ') {
+                if (color == -1) {
+                    color = cells[i].color;
+                } else if (cells[i].color != color) {
+                    break;
+                }
+            }
+
+            if (!wire_cell_equals(&cells[i], &prev_cells[i])) {
+                end = i + 1;
+            } else if ((i - end) >= WIRE_MAX_GAP) {
+                break;
+            }
+        }
+
+        /*
+         * The color may come from an unchanged cell after the run.
+         */
+        color = -1;
+
+        for (int i = start; i < end; i++) {
+            if (cells[i].c != ' ') {
+                color = cells[i].color;
+                break;
+            }
+        }
+
+        nr_runs += wire_encoder_split_run(cells, start, end, color,
+                                          &runs[nr_runs]);
+        column = end;
+    }
+
+    return nr_runs;
+}
+
+static size_t
+wire_encoder_encode_row(struct wire_encoder *encoder,
+                        const struct wire_cell *cells,
+                        const struct wire_cell *prev_cells,
+                        int start, int end, uint8_t *buffer)
+{
+    struct wire_run runs[EETG_MAX_COLUMNS];
+    int nr_runs, column;
+    size_t size;
+
+    assert(encoder);
+
+    nr_runs = wire_encoder_build_runs(cells, prev_cells, start, end, runs);
+
+    if (nr_runs == 0) {
+        return 0;
+    }
+
+    size = wire_write_varint(buffer, nr_runs);
+    column = 0;
+
+    for (int i = 0; i < nr_runs; i++) {
+        const struct wire_run *run;
+        uint32_t op;
+
+        run = &runs[i];
+        op = (uint32_t)run->length << WIRE_RUN_SHIFT;
+
+        if ((run->color != -1) && (run->color != encoder->color)) {
+            op |= WIRE_RUN_COLOR;
+        }
+
+        if (run->repeat) {
+            op |= WIRE_RUN_REPEAT;
+        }
+
+        size += wire_write_varint(&buffer[size], run->column - column);
+        size += wire_write_varint(&buffer[size], op);
+
+        if (op & WIRE_RUN_COLOR) {
+            buffer[size] = run->color;
+            size++;
+            encoder->color = run->color;
+        }
+
+        if (run->repeat) {
+            buffer[size] = cells[run->column].c;
+            size++;
+        } else {
+            for (int j = 0; j < run->length; j++) {
+                buffer[size] = cells[run->column + j].c;
+                size++;
+            }
+        }
+
+        column = run->column + run->length;
+    }
+
+    return size;
+}
+
+void
+wire_encoder_add_row(struct wire_encoder *encoder, int row,
+                     const struct wire_cell *cells,
+                     const struct wire_cell *prev_cells,
+                     int start, int end)
+{
+    size_t size;
+
+    assert(encoder);
+    assert(row >= encoder->next_row);
+    assert(row < encoder->nr_rows);
+    assert(start >= 0);
+    assert(start <= end);
+    assert(end <= encoder->nr_columns);
+
+    encoder->next_row = row + 1;
+
+    size = wire_encoder_encode_row(encoder, cells, prev_cells, start, end,
+                                   &encoder->frame[encoder->frame_size]);
+
+    if (size != 0) {
+        encoder->frame[row / 8] |= 1 << (row % 8);
+        encoder->frame_size += size;
+        assert(encoder->frame_size <= sizeof(encoder->frame));
+    }
+}
+
+void
+wire_encoder_end_frame(struct wire_encoder *encoder)
+{
+    assert(encoder);
+
+    if (!encoder->started) {
+        wire_encoder_write_header(encoder);
+        encoder->started = true;
+    }
+
+    encoder->stats.nr_frames++;
+
+    if (encoder->frame_size != encoder->bitmask_size) {
+        wire_encoder_write(encoder, encoder->frame, encoder->frame_size);
+    }
+
+    wire_encoder_start_frame(encoder);
+}
+
+void
+wire_encoder_get_stats(const struct wire_encoder *encoder,
+                       struct wire_stats *stats)
+{
+    assert(encoder);
+    assert(stats);
+
+    *stats = encoder->stats;
+}
+
+void
+wire_decoder_init(struct wire_decoder *decoder,
+                  eetg_write_fn write_fn, void *arg)
+{
+    assert(decoder);
+    assert(write_fn);
+
+    decoder->write_fn = write_fn;
+    decoder->write_fn_arg = arg;
+    wire_screen_clear(&decoder->screen);
+    decoder->nr_columns = 0;
+    decoder->nr_rows = 0;
+    decoder->nr_colors = 0;
+    decoder->color = 0;
+    decoder->started = false;
+    decoder->buffer_size = 0;
+    decoder->cursor_row = -1;
+    decoder->cursor_column = -1;
+    decoder->current_color = -1;
+    decoder->output_size = 0;
+    decoder->stats.nr_frames = 0;
+    decoder->stats.nr_bytes = 0;
+}
+
+static void
+wire_decoder_flush(struct wire_decoder *decoder)
+{
+    assert(decoder);
+
+    if (decoder->output_size == 0) {
+        return;
+    }
+
+    decoder->write_fn(decoder->output, decoder->output_size,
+                      decoder->write_fn_arg);
+    decoder->stats.nr_bytes += decoder->output_size;
+    decoder->output_size = 0;
+}
+
+static void
+wire_decoder_output(struct wire_decoder *decoder, const char *str,
+                    size_t size)
+{
+    assert(decoder);
+    assert(size <= sizeof(decoder->output));
+
+    if ((sizeof(decoder->output) - decoder->output_size) < size) {
+        wire_decoder_flush(decoder);
+    }
+
+    memcpy(&decoder->output[decoder->output_size], str, size);
+    decoder->output_size += size;
+}
+
+static void
+wire_decoder_output_str(struct wire_decoder *decoder, const char *str)
+{
+    wire_decoder_output(decoder, str, strlen(str));
+}
+
+static void
+wire_decoder_set_color(struct wire_decoder *decoder, int color)
+{
+    char str[32];
+
+    assert(decoder);
+
+    if (color == decoder->current_color) {
+        return;
+    }
+
+    snprintf(str, sizeof(str), WIRE_CSI "%d;%dm",
+             color + 30, WIRE_BG_COLOR + 40);
+    wire_decoder_output_str(decoder, str);
+    decoder->current_color = color;
+}
+
+static void
+wire_decoder_set_cursor(struct wire_decoder *decoder, int row, int column)
+{
+    char str[32];
+
+    assert(decoder);
+
+    if ((row == decoder->cursor_row) && (column == decoder->cursor_column)) {
+        return;
+    }
+
+    if ((row == decoder->cursor_row) && (decoder->cursor_column != -1)
+        && (column > decoder->cursor_column)) {
+        snprintf(str, sizeof(str), WIRE_CSI "%dC",
+                 column - decoder->cursor_column);
+    } else {
+        snprintf(str, sizeof(str), WIRE_CSI "%d;%dH", row + 1, column + 1);
+    }
+
+    wire_decoder_output_str(decoder, str);
+    decoder->cursor_row = row;
+    decoder->cursor_column = column;
+}
+
+/*
+ * Display a cell, if it changed.
+ */
+static void
+wire_decoder_paint_cell(struct wire_decoder *decoder, int row, int column,
+                        char c)
+{
+    struct wire_cell *cell, new_cell;
+
+    assert(decoder);
+
+    cell = &decoder->screen.cells[row][column];
+    new_cell.c = c;
+    new_cell.color = decoder->color;
+
+    if (wire_cell_equals(cell, &new_cell)) {
+        return;
+    }
+
+    *cell = new_cell;
+
+    wire_decoder_set_cursor(decoder, row, column);
+
+    if (c != ' ') {
+        wire_decoder_set_color(decoder, decoder->palette[decoder->color]);
+    }
+
+    wire_decoder_output(decoder, &c, 1);
+
+    /*
+     * As with common terminals, the cursor doesn't wrap when writing to
+     * the last column, and its position is then left undefined.
+     */
+    decoder->cursor_column++;
+
+    if (decoder->cursor_column == decoder->nr_columns) {
+        decoder->cursor_row = -1;
+        decoder->cursor_column = -1;
+    }
+}
+
+static bool
+wire_decoder_parse_header(struct wire_decoder *decoder,
+                          struct wire_reader *reader, bool apply)
+{
+    uint8_t magic[3], version, nr_colors;
+    int8_t palette[WIRE_NR_COLORS];
+    uint32_t nr_rows, nr_columns;
+
+    assert(decoder);
+
+    for (size_t i = 0; i < ARRAY_SIZE(magic); i++) {
+        if (!wire_reader_read_byte(reader, &magic[i])) {
+            return false;
+        }
+    }
+
+    if ((memcmp(magic, WIRE_MAGIC, sizeof(magic)) != 0)
+        || !wire_reader_read_byte(reader, &version)
+        || (version != WIRE_VERSION)
+        || !wire_reader_read_varint(reader, &nr_rows)
+        || (nr_rows == 0)
+        || (nr_rows > EETG_MAX_ROWS)
+        || !wire_reader_read_varint(reader, &nr_columns)
+        || (nr_columns == 0)
+        || (nr_columns > EETG_MAX_COLUMNS)
+        || !wire_reader_read_byte(reader, &nr_colors)
+        || (nr_colors == 0)
+        || (nr_colors > WIRE_NR_COLORS)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < nr_colors; i++) {
+        uint8_t color;
+
+        if (!wire_reader_read_byte(reader, &color)
+            || (color > EETG_COLOR_WHITE)) {
+            return false;
+        }
+
+        palette[i] = color;
+    }
+
+    if (!apply) {
+        return true;
+    }
+
+    decoder->nr_columns = nr_columns;
+    decoder->nr_rows = nr_rows;
+    memcpy(decoder->palette, palette, nr_colors);
+    decoder->nr_colors = nr_colors;
+    decoder->started = true;
+
+    wire_decoder_output_str(decoder, WIRE_CSI "?25l"); /* cursor invisible */
+    wire_decoder_set_color(decoder, WIRE_FG_COLOR);
+    wire_decoder_output_str(decoder, WIRE_CSI "2J"); /* clear screen */
+
+    return true;
+}
+
+static bool
+wire_decoder_parse_run(struct wire_decoder *decoder,
+                       struct wire_reader *reader, int row, int *column,
+                       bool apply)
+{
+    uint32_t gap, op, length;
+    uint8_t color, c = ' ';
+
+    assert(decoder);
+    assert(column);
+
+    if (!wire_reader_read_varint(reader, &gap)
+        || !wire_reader_read_varint(reader, &op)) {
+        return false;
+    }
+
+    length = op >> WIRE_RUN_SHIFT;
+
+    if ((gap > (uint32_t)(decoder->nr_columns - *column)) || (length == 0)
+        || (length > (decoder->nr_columns - *column - gap))) {
+        return false;
+    }
+
+    *column += gap;
+
+    if (op & WIRE_RUN_COLOR) {
+        if (!wire_reader_read_byte(reader, &color)
+            || (color >= decoder->nr_colors)) {
+            return false;
+        }
+
+        if (apply) {
+            decoder->color = color;
+        }
+    }
+
+    for (uint32_t i = 0; i < length; i++) {
+        if ((i == 0) || !(op & WIRE_RUN_REPEAT)) {
+            if (!wire_reader_read_byte(reader, &c)
+                || (c < ' ') || (c > '~')) {
+                return false;
+            }
+        }
+
+        if (apply) {
+            wire_decoder_paint_cell(decoder, row, *column, c);
+        }
+
+        (*column)++;
+    }
+
+    return true;
+}
+
+static bool
+wire_decoder_parse_frame(struct wire_decoder *decoder,
+                         struct wire_reader *reader, bool apply)
+{
+    uint8_t bitmask[WIRE_BITMASK_SIZE(EETG_MAX_ROWS)];
+    int bitmask_size;
+
+    assert(decoder);
+
+    bitmask_size = WIRE_BITMASK_SIZE(decoder->nr_rows);
+
+    for (int i = 0; i < bitmask_size; i++) {
+        if (!wire_reader_read_byte(reader, &bitmask[i])) {
+            return false;
+        }
+    }
+
+    for (int row = 0; row < (bitmask_size * 8); row++) {
+        uint32_t nr_runs;
+        int column;
+
+        if (!(bitmask[row / 8] & (1 << (row % 8)))) {
+            continue;
+        }
+
+        if ((row >= decoder->nr_rows)
+            || !wire_reader_read_varint(reader, &nr_runs)
+            || (nr_runs == 0)
+            || (nr_runs > (uint32_t)decoder->nr_columns)) {
+            return false;
+        }
+
+        column = 0;
+
+        for (uint32_t i = 0; i < nr_runs; i++) {
+            if (!wire_decoder_parse_run(decoder, reader, row, &column,
+                                        apply)) {
+                return false;
+            }
+        }
+    }
+
+    if (apply) {
+        decoder->stats.nr_frames++;
+    }
+
+    return true;
+}
+
+static bool
+wire_decoder_parse_message(struct wire_decoder *decoder,
+                           struct wire_reader *reader, bool apply)
+{
+    assert(decoder);
+
+    if (!decoder->started) {
+        return wire_decoder_parse_header(decoder, reader, apply);
+    }
+
+    return wire_decoder_parse_frame(decoder, reader, apply);
+}
+
+/*
+ * Process the complete messages in the buffer.
+ *
+ * Messages are checked before being applied, so that an incomplete
+ * message is left untouched until more bytes are received.
+ */
+static bool
+wire_decoder_parse(struct wire_decoder *decoder)
+{
+    size_t i = 0;
+
+    assert(decoder);
+
+    while (i < decoder->buffer_size) {
+        struct wire_reader reader;
+        const uint8_t *msg;
+        size_t size;
+
+        msg = &decoder->buffer[i];
+        size = decoder->buffer_size - i;
+        wire_reader_init(&reader, msg, size);
+
+        if (!wire_decoder_parse_message(decoder, &reader, false)) {
+            if (!reader.truncated) {
+                return false;
+            }
+
+            break;
+        }
+
+        wire_reader_init(&reader, msg, size);
+        wire_decoder_parse_message(decoder, &reader, true);
+        wire_decoder_flush(decoder);
+        i += reader.index;
+    }
+
+    memmove(decoder->buffer, &decoder->buffer[i], decoder->buffer_size - i);
+    decoder->buffer_size -= i;
+
+    return true;
+}
+
+bool
+wire_decoder_write(struct wire_decoder *decoder,
+                   const void *buffer, size_t size)
+{
+    const uint8_t *ptr = buffer;
+
+    assert(decoder);
+
+    while (size != 0) {
+        size_t room, nr_bytes;
+
+        room = sizeof(decoder->buffer) - decoder->buffer_size;
+
+        /*
+         * The buffer holds any complete message.
+         */
+        if (room == 0) {
+            return false;
+        }
+
+        nr_bytes = (size < room) ? size : room;
+        memcpy(&decoder->buffer[decoder->buffer_size], ptr, nr_bytes);
+        decoder->buffer_size += nr_bytes;
+        ptr += nr_bytes;
+        size -= nr_bytes;
+
+        if (!wire_decoder_parse(decoder)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void
+wire_decoder_get_stats(const struct wire_decoder *decoder,
+                       struct wire_stats *stats)
+{
+    assert(decoder);
+    assert(stats);
+
+    *stats = decoder->stats;
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2024 Richard Braun.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for
+ * any purpose with or without fee is hereby granted.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS” AND THE AUTHOR DISCLAIMS ALL
+ * WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE
+ * FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY
+ * DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN
+ * AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT
+ * OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *
+ * Compact frame protocol.
+ *
+ * Instead of terminal sequences, an encoder sends the cells which changed
+ * since the previous frame, in a binary form, and a decoder, normally in a
+ * thin client next to the terminal, rebuilds the screen and paints it with
+ * terminal sequences of its own.
+ *
+ * The stream starts with a header giving the screen size and a palette,
+ * mapping color indexes to ANSI colors. Each frame then starts with a
+ * bitmask of the rows which changed, followed, for each of those rows, by
+ * a list of runs. A run starts with the number of columns skipped since
+ * the end of the previous run, and its length, as varints, followed by
+ * either the characters of the run, or a single character repeated over
+ * it. A run may also set the current color, which applies to the runs
+ * after it, across rows and frames, so that colors are only sent when
+ * they change. Frames without changes aren't sent.
+ *
+ * The color of blank cells isn't visible, and isn't preserved.
+ */
+
+#ifndef WIRE_H
+#define WIRE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "eetg.h"
+
+#define WIRE_NR_COLORS      8
+
+/*
+ * Size of the row bitmask of a frame, in bytes.
+ */
+#define WIRE_BITMASK_SIZE(nr_rows)  (((nr_rows) + 7) / 8)
+
+/*
+ * Maximum size of a frame, in bytes.
+ *
+ * A row starts with its number of runs, a varint of at most two bytes,
+ * and a run costs at most four bytes per cell.
+ */
+#if EETG_MAX_COLUMNS >= (1 << 14)
+#error "the number of runs of a row is limited to two bytes"
+#endif
+
+#define WIRE_FRAME_SIZE     (WIRE_BITMASK_SIZE(EETG_MAX_ROWS) \
+                             + (EETG_MAX_ROWS \
+                                * (2 + (EETG_MAX_COLUMNS * 4))))
+
+/*
+ * Maximum size of the header, in bytes.
+ */
+#define WIRE_HEADER_SIZE    (15 + WIRE_NR_COLORS)
+
+#define WIRE_BUFFER_SIZE    (WIRE_FRAME_SIZE + WIRE_HEADER_SIZE)
+
+/*
+ * Size of the buffer of terminal sequences produced by a decoder.
+ */
+#define WIRE_OUTPUT_SIZE    4096
+
+struct wire_cell {
+    char c;
+    int8_t color;
+};
+
+struct wire_screen {
+    struct wire_cell cells[EETG_MAX_ROWS][EETG_MAX_COLUMNS];
+};
+
+struct wire_stats {
+    unsigned long nr_frames;
+    uint64_t nr_bytes;
+};
+
+struct wire_encoder {
+    eetg_write_fn write_fn;
+    void *write_fn_arg;
+    int nr_columns;
+    int nr_rows;
+    size_t bitmask_size;
+    int color;
+    bool started;
+    int next_row;
+    size_t frame_size;
+    uint8_t frame[WIRE_FRAME_SIZE];
+    struct wire_stats stats;
+};
+
+struct wire_decoder {
+    eetg_write_fn write_fn;
+    void *write_fn_arg;
+    struct wire_screen screen;
+    int nr_columns;
+    int nr_rows;
+    int8_t palette[WIRE_NR_COLORS];
+    size_t nr_colors;
+    int color;
+    bool started;
+    uint8_t buffer[WIRE_BUFFER_SIZE];
+    size_t buffer_size;
+    int cursor_row;
+    int cursor_column;
+    int current_color;
+    char output[WIRE_OUTPUT_SIZE];
+    size_t output_size;
+    struct wire_stats stats;
+};
+
+/*
+ * Initialize an encoder of frames of the given size, writing to the given
+ * backend.
+ *
+ * The first frame is decoded on a blank screen.
+ */
+void wire_encoder_init(struct wire_encoder *encoder,
+                       int nr_columns, int nr_rows,
+                       eetg_write_fn write_fn, void *arg);
+
+/*
+ * Encode the cells of a row which may have changed since the previous
+ * frame, between the given columns, end excluded.
+ *
+ * The cells of the row, and those they replace, are indexed by column.
+ * Rows are added in increasing order, at most once per frame.
+ */
+void wire_encoder_add_row(struct wire_encoder *encoder, int row,
+                          const struct wire_cell *cells,
+                          const struct wire_cell *prev_cells,
+                          int start, int end);
+
+/*
+ * Write the rows added since the previous frame, if any changed.
+ *
+ * The header is written with the first frame.
+ */
+void wire_encoder_end_frame(struct wire_encoder *encoder);
+
+/*
+ * Return the number of frames ended, and of bytes written.
+ */
+void wire_encoder_get_stats(const struct wire_encoder *encoder,
+                            struct wire_stats *stats);
+
+/*
+ * Initialize a decoder, writing terminal sequences to the given backend.
+ *
+ * The screen size is taken from the header of the stream.
+ */
+void wire_decoder_init(struct wire_decoder *decoder,
+                       eetg_write_fn write_fn, void *arg);
+
+/*
+ * Decode bytes of a stream, which may be split anywhere, and display the
+ * frames they complete.
+ *
+ * Return false if the stream is invalid.
+ */
+bool wire_decoder_write(struct wire_decoder *decoder,
+                        const void *buffer, size_t size);
+
+/*
+ * Return the number of frames decoded, and of bytes of terminal sequences
+ * written.
+ */
+void wire_decoder_get_stats(const struct wire_decoder *decoder,
+                            struct wire_stats *stats);
+
+#endif /* WIRE_H */